@@ -1,996 +1,1681 @@
-// TAPjack source code
-// last modified 4/19/2024
-// ASCII cards designed by Kevin Lei
-// Ultrasonic Sensor functions designed by Quinn Frady
-// game logic and screen display functions designed by Nathan Ramos
-
-// for USART
-#define F_CPU 8000000UL
-#define BAUD 38400
-#define MYUBRR F_CPU/16/BAUD-1
-#define ASCII_NUM 48
-// for USS
-#define HCSR04CONST 58.2
-#define THRESHOLD 200
-#define WIDTH 22.0
-#define DIST_HIT 8.0
-#define DIST_STAY 35.0
-// for ADC
-#define VREF 5
-#define STEPS 1024
-#define STEPSIZE VREF/STEPS
-// blackjack constants
-#define NUMPLAYERS 5
-#define SINGLEDECK 52
-#define MAXSUIT 13
-#define MAXRANK 4
-#define MAXHAND 12
-//display config
-// For 150% Display scale: 37 char terminal height, hide task bar
-// For 175% display scaling: 28x165, hide task bar
-#define TERMHEIGHT 28
-#define TERMWIDTH 165
-// delays
-#define DELAY_INPUT 200
-#define DELAY_REFRESH 2000
-#define DELAY_READ 4000
-#define DELAY_RESULTS 10000
-
-// DO NOT CHANGE
-#define NL '\n'
-#define HIT 1
-#define STAY 2
-#define NOACTION 3
-#define ERROR 0
-#define DEALER 0
-#define P1 1
-#define P2 2
-#define P3 3
-#define P4 4
-
-#include <avr/io.h>
-#include <avr/delay.h>
-#include <avr/interrupt.h>
-#include <stdlib.h>
-#include <string.h>
-
-typedef struct hand {
-	int rank[MAXHAND]; // 1 = Ace, 2-9, 10 = T, 11 = Jack, 12 = Queen, 13 = King
-	char suit[MAXHAND]; // h = hearts, d = diamonds, c = clubs, s = spades
-	int isFaceDown[MAXHAND]; // true = card value is hidden, false = card value is shown
-	int handsize; // number of cards in one player's hand
-	int handvalue; // how many points the player's hand is worth
-	int busted; // true = hand value over 21, false = hand value 21 or under
-	int soft; // true = hand value can decrease to stay under 22 (has Aces), false = hand value cannot decrease
-    int empty; // true = hand has zero cards, false = hand has at least one card
-	} hand;
-
-// global vars
-char suitG[SINGLEDECK]; // h = hearts, d = diamonds, c = clubs, s = spades
-int rankG[SINGLEDECK]; // 1 = Ace, 2-9, 10 = T, 11 = Jack, 12 = Queen, 13 = King, 14 = blind
-int indexG; // index of unassigned card in deck
-
-int outcome[NUMPLAYERS]; // win = 1, loss = 0, push = 2
-int SCREENFILL = TERMHEIGHT; // for screen refresh
-int timerOverflow = 0; // for ultrasonic sensor
-
-hand p1a, p1b, p2a, p2b, p3a, p3b, p4a, p4b; // 4 players each have a main hand and an extra hand for a split scenario
-hand dealer; // dealer's hand
-
-// display logic
-void cardPrint(hand *p); // print entire hand
-char rankConvert(int rank);
-void fillScreen(int lines); // fill the rest of the terminal
-void alignCenter(int strWidth); // displays a line of strings that is centered
-void dispUpper(int ID); // prints everything from the dealer's hand upwards
-void dispIntro(); // display welcome greeting & credits
-void dispBlank(); // display blank screen
-void dispRound(int round); // display round screen
-void dispTurn(int ID); // display turn screen
-void dispResults(); // decides win or push or loss
-
-// reset logic
-void emptyHand(hand *p); // empty player's hand 
-void newRound(); // starts a brand new round of blackjack
-void initDeck(); // initialize deck of 52 playing cards
-void shuffleDeck(); // shuffle the deck
-int ADC_rand(); // grab random digital voltage from ADC (light sensor)
-
-// game logic
-void playTurn(int ID); // enact player's turn
-void dealCard(hand *p); // deal 1 card
-void split(int ID);
-int userInput(); // get player's desired input
-void selectPlayer(int ID, hand** pA, hand** pB); // get desired player hands
-
-// USART
-void USART_init(unsigned int ubrr); // init USART
-void send(const char* data); // send string
-void sendChar(const char data); // send char
-
-// UltraSonicSensor
-void USS_init(); // init USS
-double USS_distance(); // get distance
-int USS_move(); // get move from the sensor
-
-// interrupt subroutine for handling the timer
-ISR(TIMER1_OVF_vect)
-{
-	cli(); // disable interrupts
-	timerOverflow++;	// Increment Timer Overflow count
-	sei(); // enable interrupts
-}
-
-int main() {
-    // initialize USART
-	USART_init(MYUBRR);
-	// initialize USS
-	USS_init();
-	// initialize deck of cards
-	initDeck();
-    // seed rand()
-    srand(ADC_rand());
-
-    dispBlank(); // display blank screen
-    dispIntro(); // display introduction screen
-    dispBlank(); // display blank screen
-
-    // game runs for 999 rounds
-    for (int round = 1; round < 1000; round++) {
-        dispRound(round); // display round screen
-        newRound(); // starts a new round
-
-        // deal out the starting hands in proper casino order
-		for (int i = 0; i < 2; i++) {
-			dealCard(&p1a);
-			dealCard(&p2a);
-			dealCard(&p3a);
-			dealCard(&p4a);
-			dealCard(&dealer);
-		}
-		dealer.isFaceDown[0] = 1; // hide dealer's first card from view
-        
-        // Give each player a turn to interact with the game
-        for(int pNow = P1; pNow <= P4; pNow++) {
-            dispBlank(); // display blank screen
-			dispTurn(pNow); // display player turn screen
-            playTurn(pNow); // allow player input for their turn
-		}
-		dealer.isFaceDown[0] = 0; // show dealer's first card
-        // loop for dealer's turn
-        while (1) {
-            // display dealer's cards for one screen instance
-            SCREENFILL = TERMHEIGHT;
-            dispUpper(DEALER);
-            fillScreen(SCREENFILL);
-			_delay_ms(DELAY_REFRESH);
-            sendChar(NL);
-
-            // display dealer's cards for another screen instance
-            SCREENFILL = TERMHEIGHT;
-            dispUpper(DEALER);
-            sendChar(NL);
-            sendChar(NL);
-            SCREENFILL -= 2;
-            if (dealer.busted) { // dealer busts
-                alignCenter(14);
-                send("Dealer BUSTED!");
-                fillScreen(SCREENFILL);
-                _delay_ms(DELAY_READ);
-                sendChar(NL);
-                break;
-            } else if ((dealer.handvalue < 17) || (dealer.handvalue == 17 && dealer.soft)) { // dealer can continue drawing
-                alignCenter(12);
-				send("Dealer hits!");
-				dealCard(&dealer);
-                fillScreen(SCREENFILL);
-                _delay_ms(DELAY_REFRESH);
-                sendChar(NL);
-			} else { // dealer has reached a hand value from hard 17 up to 21
-                alignCenter(20);
-				send("Dealer stays with ");
-				char d[3];
-				itoa(dealer.handvalue,d,10);
-				send(d);
-				send("!");
-                fillScreen(SCREENFILL);
-                _delay_ms(DELAY_READ);
-                sendChar(NL);
-				break;
-			}
-        }
-        dispResults(); // display results screen
-    }
-}
-// displays entire hand of given player
-void cardPrint(hand *p) {
-    int numCards = p->handsize;
-	unsigned int k;
-	/*Border(s)*/
-    alignCenter(numCards*14);
-	for(k = 0; k < numCards; k++) {
-	 send(" +-----------+");
-	}
-	sendChar(NL);
-	/*TopRank(s)*/
-    alignCenter(numCards*14);
-	for(k = 0; k < numCards; k++) {
-	 if (p->isFaceDown[k]) { send(" |###########|"); }
-	 else { 
-		 send(" | ");
-		 sendChar(rankConvert(p->rank[k])); 
-		 send("         ");
-		 send("|");
-		 }
-	}
-	sendChar(NL);
-	/*Spacer(s)*/
-    alignCenter(numCards*14);
-	for(k = 0; k < numCards; k++) {
-	 if (p->isFaceDown[k]) { send(" |####   ####|"); }
-	 else { send(" |           |"); }
-	}
-	sendChar(NL);
-
-	// Printing 1st line of body
-    alignCenter(numCards*14);
-	for(k = 0; k < numCards; k++) {
-        if (p->isFaceDown[k]) { 
-            send(" |#### U ####|");
-        }
-        else switch(p->suit[k]) {
-            case 'h': send(" |    _ _    |"); break;
-            case 'd': send(" |     ^     |"); break;
-            case 'c': send(" |     _     |"); break;
-            case 's': send(" |     .     |"); break;
-            default : send(" |   ERROR   |"); break;
-        }
-	}
-	sendChar(NL); // Next line
-	// Printing 2nd line of body
-    alignCenter(numCards*14);
-	for(k = 0; k < numCards; k++) {
-        if (p->isFaceDown[k]) {
-            send(" |#### N ####|");
-        }
-        else switch(p->suit[k]) {
-            case 'h': send(" |   ( V )   |"); break;
-            case 'd': send(" |    / \\    |"); break;
-            case 'c': send(" |    (&)    |"); break;
-            case 's': send(" |    /&\\    |"); break;
-            default : send(" |   ERROR   |"); break;
-        }
-	}
-	sendChar(NL); // Next line
-	// Printing 3rd line of body
-    alignCenter(numCards*14);
-	for(k = 0; k < numCards; k++) {
-        if (p->isFaceDown[k]) {
-            send(" |#### L ####|");
-        }
-        else switch(p->suit[k]) {
-            case 'h': send(" |    \\ /    |"); break;
-            case 'd': send(" |    \\ /    |"); break;
-            case 'c': send(" |   (&&&)   |"); break;
-            case 's': send(" |   (&&&)   |"); break;
-            default : send(" |   ERROR   |"); break;
-        }
-	}
-	sendChar(NL); // Next line
-	 // Printing 4th line of body
-    alignCenter(numCards*14);
-	 for(k = 0; k < numCards; k++) {
-            if (p->isFaceDown[k]) {
-                send(" |#### V ####|");
-            }
-            else switch(p->suit[k]) {
-                case 'h': send(" |     V     |"); break;
-                case 'd': send(" |     V     |"); break;
-                case 'c': send(" |     ^     |"); break;
-                case 's': send(" |     ^     |"); break;
-                default : send(" |   ERROR   |"); break;
-            }
-	 }
-	sendChar(NL); // Next line
-    /*Spacer(s)*/
-    alignCenter(numCards*14);
-	for(k = 0; k < numCards; k++) {
-	 if (p->isFaceDown[k]) { send(" |####   ####|"); }
-	 else { send(" |           |"); }
-	}
-	sendChar(NL);
-	/*BotRank(s)*/
-    alignCenter(numCards*14);
-	for(k = 0; k < numCards; k++) {
-	 if (p->isFaceDown[k]) { send(" |###########|"); }
-	 else {
-		 send(" |");
-		 send("         ");
-		 sendChar(rankConvert(p->rank[k]));
-		 send(" |");
-	 }
-	}
-	sendChar(NL);
-	/*Border(s)*/
-    alignCenter(numCards*14);
-	for(k = 0; k < numCards; k++) {
-	 send(" +-----------+");
-	}
-	sendChar(NL);
-	SCREENFILL -= 10;
-}
-// Converts numeric card to it's respective char representation
-char rankConvert(int rank) {
-	switch (rank) {
-		case  1: return 'A';
-		case 13: return 'K';
-		case 12: return 'Q';
-		case 11: return 'J';
-		case 10: return 'T';
-		default: return (rank + ASCII_NUM);
-	}
-}
-// fills rest of the display screen with blank space
-void fillScreen(int lines) {
-    for (;lines > 0; lines--) {
-        sendChar(NL);
-    }
-}
-// center-justifies text on the screen
-void alignCenter(int strWidth) {
-    for (int i = (TERMWIDTH - strWidth)/2; i > 0; i--) {
-        sendChar(' ');
-    }
-}
-// displays the upper part of the screen right before cards are displayed
-void dispUpper(int ID) {
-    char temp[6];
-    hand *pA, *pB;
-	if (ID == DEALER) {
-		send("DEALER'S TURN.  ");
-        ID = 4;
-	} else {
-		send("PLAYER ");
-		sendChar(ID + ASCII_NUM);
-		send("'S TURN.");
-    }
-    send("				");
-
-    for (int i = 1; i <= ID; i++) {
-        selectPlayer(i, &pA, &pB);
-        send("Player ");
-		sendChar(i + ASCII_NUM);
-		send("'s hand: [");
-        itoa(pA->handvalue,temp,10);
-        send(temp);
-        
-        if (!pB->empty) {
-            send("][");
-            itoa(pB->handvalue,temp,10);
-            send(temp);
-        }
-        send("]	");
-    }
-    sendChar(NL);
-    sendChar(NL);
-    alignCenter(18);
-    send("Dealer is showing:");
-    sendChar(NL);
-    SCREENFILL -= 3;
-
-    cardPrint(&dealer);
-}
-// displays introduction screen
-void dispIntro() {
-    SCREENFILL = TERMHEIGHT;
-    fillScreen(2);
-    SCREENFILL -= 2;
-    alignCenter(45); send("WELCOME TO TOUCHLESS AUTOMATED PLAY BLACKJACK\n");
-    alignCenter(3); send("AKA\n");
-    alignCenter(67); send(" ______   ______     ______     __     ______     ______     __  __\n");   
-    alignCenter(67); send("/\\__  _\\ /\\  __ \\   /\\  == \\   /\\ \\   /\\  __ \\   /\\  ___\\   /\\ \\/ /\n");   
-    alignCenter(67); send("\\/_/\\ \\/ \\ \\  __ \\  \\ \\  _-/  _\\_\\ \\  \\ \\  __ \\  \\ \\ \\____  \\ \\  _\"-.\n"); 
-    alignCenter(67); send("   \\ \\_\\  \\ \\_\\ \\_\\  \\ \\_\\   /\\_____\\  \\ \\_\\ \\_\\  \\ \\_____\\  \\ \\_\\ \\_\\\n");
-    alignCenter(67); send("    \\/_/   \\/_/\\/_/   \\/_/   \\/_____/   \\/_/\\/_/   \\/_____/   \\/_/\\/_/\n");
-	SCREENFILL -= 10;
-	fillScreen(SCREENFILL);
-	_delay_ms(DELAY_REFRESH);
-    sendChar(NL);
-	
-	SCREENFILL = TERMHEIGHT;
-	fillScreen(13);
-	alignCenter(10);
-	send("CREATED BY\n");
-	alignCenter(38);
-	send("Nathan Ramos, Kevin Lei, & Quinn Frady");
-	SCREENFILL -= 16;
-	fillScreen(SCREENFILL);
-	_delay_ms(DELAY_REFRESH);
-    sendChar(NL);
-}
-// displays blank screen
-void dispBlank() {
-    // blank screen
-	SCREENFILL = TERMHEIGHT;
-	fillScreen(SCREENFILL);
-	_delay_ms(DELAY_REFRESH);
-    sendChar(NL);
-}
-// displays round screen
-void dispRound(int round) {
-    SCREENFILL = TERMHEIGHT;
-    fillScreen(15);
-    alignCenter(7);
-    send("Round ");
-    char str[5];
-    itoa(round,str,10);
-    send(str);
-    SCREENFILL -= 15;
-    fillScreen(SCREENFILL);
-    _delay_ms(DELAY_REFRESH);
-    sendChar(NL); 
-}
-// displays player turn screen
-void dispTurn(int ID) {
-    SCREENFILL = TERMHEIGHT;
-    fillScreen(15);
-    if (ID == DEALER) {
-        alignCenter(13);
-        send ("DEALER'S TURN");
-    } else {
-        alignCenter(15);
-        send("PLAYER ");
-        sendChar(ID + ASCII_NUM);
-        send("'S TURN");
-    }
-    SCREENFILL -= 15;
-    fillScreen(SCREENFILL);
-    _delay_ms(DELAY_REFRESH);  
-    sendChar(NL);
-}
-// displays results of the round
-void dispResults() {
-    SCREENFILL = TERMHEIGHT;
-    dealer.isFaceDown[0] = 0;
-    dispUpper(DEALER);
-    sendChar(NL);
-    if (dealer.busted) {
-        alignCenter(14);
-        send("Dealer BUSTED!");
-    } else {
-        alignCenter(20);
-        send("Dealer stays with ");
-        char d[3];
-		itoa(dealer.handvalue,d,10);
-        send(d);
-    }
-    sendChar(NL);
-    sendChar(NL);
-    sendChar(NL);
-    SCREENFILL -= 4;
-
-    hand *pA, *pB;
-    for (int ID = P1; ID <= P4; ID++) {
-        selectPlayer (ID, &pA, &pB);
-        send("      Player ");
-        sendChar(ID + ASCII_NUM);
-        if (pA->busted) {
-            send(" LOST with ");
-        } else if (pA->handvalue == dealer.handvalue) {
-            send(" PUSHED with ");
-        } else if (pA->handvalue < dealer.handvalue && !dealer.busted) {
-            send(" LOST with ");
-        } else if (pA->handvalue > dealer.handvalue || dealer.busted) {
-            send(" WON with ");
-        } else {
-            send("ERROR in dispResults()");
-        }
-        char temp[3];
-		itoa(pA->handvalue,temp,10);
-		send(temp);
-        if (!pB->empty) {
-            send (" and");
-            if (pB->busted) {
-                send(" LOST with ");
-            } else if (pB->handvalue == dealer.handvalue) {
-                send(" PUSHED with ");
-            } else if (pB->handvalue < dealer.handvalue && !dealer.busted) {
-                send(" LOST with ");
-            } else if (pB->handvalue > dealer.handvalue || dealer.busted) {
-                send(" WON with ");
-            } else {
-                send("ERROR in dispResults()");
-            }
-            char temp[3];
-		    itoa(pB->handvalue,temp,10);
-		    send(temp);
-        }
-        sendChar(NL);
-        sendChar(NL);
-        SCREENFILL -= 2;
-    }
-    fillScreen(SCREENFILL);
-    _delay_ms(DELAY_RESULTS);
-	sendChar(NL);
-	return;
-}
-// empties given hand
-void emptyHand(hand *p) {
-    for (int i = 0; i < MAXHAND; i++) {
-		p->rank[i] = 0;
-		p->suit[i] = 0;
-		p->isFaceDown[i] = 0;
-	}
-	p->handsize = 0;
-	p->handvalue = 0;
-	p->busted = 0;
-	p->soft = 0;
-    p->empty = 1;
-}
-// initializes everybody's hands and shuffles the deck
-void newRound() {
-    emptyHand(&dealer);
-	emptyHand(&p1a);
-	emptyHand(&p2a);
-	emptyHand(&p3a);
-	emptyHand(&p4a);
-    emptyHand(&p1b);
-	emptyHand(&p2b);
-	emptyHand(&p3b);
-	emptyHand(&p4b);
-	shuffleDeck();
-}
-// initializes a standard 52 card poker deck
-void initDeck() {
-    indexG = 0;
-	for (int i = 0; i < SINGLEDECK; i++) {
-		if		(i > (3 * MAXSUIT - 1)) { suitG[i] = 'h'; }
-		else if (i > (2 * MAXSUIT - 1)) { suitG[i] = 'd'; }
-		else if (i > (MAXSUIT - 1))		{ suitG[i] = 'c'; }
-		else							{ suitG[i] = 's'; }
-		rankG[i] = (i % MAXSUIT) + 1;
-	}
-	// EXTREME TAPJACK: ACE OF SPADES
-// 	for (int i = 0; i < SINGLEDECK; i++) {
-// 		rankG[i] = 1;
-// 		suitG[i] = 's';
-// 	}
-}
-// shuffles a deck of playing cards using rand() seeded through lavaRND
-void shuffleDeck() {
-    indexG = 0;
-	for (int i = 0; i < SINGLEDECK; i++) {
-		unsigned int j = rand() % SINGLEDECK;
-		unsigned int tempR = rankG[j];
-		unsigned char tempS = suitG[j];
-		rankG[j] = rankG[i];
-		suitG[j] = suitG[i];
-		rankG[i] = tempR;
-		suitG[i] = tempS;
-	}
-}
-// reads light values from light sensor and converts analog value to digital for RNG seed
-int ADC_rand() {
-    DDRC = (0 << PINC0); // ADC0 input
-	ADMUX = (1 << REFS0) | (0 << MUX0); // input ADC0, left justified, AVcc
-	// enable ADC, set prescaler to 64
-	ADCSRA |= (1 << ADEN) | (1 << ADPS2) | (1 << ADPS1);
-	ADCSRA |= (1 << ADSC); // start ADC conversion
-	while (ADCSRA & (1 << ADSC)); // wait until ADC finishes
-	ADCSRA ^= (1 << ADEN); // disable ADC
-	return ADC;
-}
-// display's player's active turn on screen and accepts player input
-void playTurn(int ID) {
-    hand *pA, *pB;
-	int askSplit = 1;
-    selectPlayer(ID, &pA, &pB);
-    while (1) { // player's turn for their first hand
-		// display player's turn screen
-        SCREENFILL = TERMHEIGHT;
-		dispUpper(ID);
-		sendChar(NL);
-        alignCenter(23);
-		send("Your current hand: [");
-		char temp[3];
-		itoa(pA->handvalue,temp,10);
-		send(temp);
-		send("]");
-		sendChar(NL);
-		cardPrint(&(*pA));
-		SCREENFILL -= 2;
-		fillScreen(SCREENFILL);
-		_delay_ms(DELAY_REFRESH);
-		sendChar(NL);
-		
-        // display's player's turn screen along with interactive questions
-        SCREENFILL = TERMHEIGHT;
-        dispUpper(ID);
-        sendChar(NL);
-        alignCenter(23);
-        send("Your current hand: [");
-        itoa(pA->handvalue,temp,10);
-        send(temp);
-        send("]");
-        sendChar(NL);
-        cardPrint(&(*pA));
-        SCREENFILL -= 2;
-        sendChar(NL);
-        sendChar(NL);
-        SCREENFILL -= 2;
-        if ((pA->rank[0] == pA->rank[1]) && askSplit) { // player's hand has the option to split
-            alignCenter(34);
-            send("SPLIT? (HIT for YES) (STAY for NO)");
-            fillScreen(SCREENFILL);
-            if (userInput() == HIT) {
-                sendChar(NL);
-                split(ID); // handles the screen display and refresh
-            }
-			askSplit = 0; 
-            continue;
-        } else if (pA->busted) { // player's hand is worth more than 21
-            alignCenter(11);
-            send("You BUSTED!");
-            fillScreen(SCREENFILL);
-            _delay_ms(DELAY_READ);
-            sendChar(NL);
-            break;
-        } else if (pA->handvalue == 21) { // player's hand is worth 21
-            alignCenter(16);
-            send("You got TAPJACK!");
-            fillScreen(SCREENFILL);
-            _delay_ms(DELAY_READ);
-            sendChar(NL);
-            break;
-        } else { // player can hit or stay
-            alignCenter(12);
-            send("HIT or STAY?");
-            fillScreen(SCREENFILL);
-            int choice = userInput();
-            _delay_ms(DELAY_INPUT);
-            sendChar(NL);
-
-            SCREENFILL = TERMHEIGHT;
-            dispUpper(ID);
-            sendChar(NL);
-            alignCenter(23);
-            send("Your current hand: [");
-            char temp[3];
-            itoa(pA->handvalue,temp,10);
-            send(temp);
-            send("]");
-            sendChar(NL);
-            cardPrint(&(*pA));
-            SCREENFILL -= 2;
-            sendChar(NL);
-            sendChar(NL);
-            SCREENFILL -= 2;
-            if (choice == HIT) { // player decided to hit
-                alignCenter(8);
-                send("You hit!");
-                dealCard(&(*pA));
-                fillScreen(SCREENFILL);
-                _delay_ms(DELAY_REFRESH);
-                sendChar(NL);
-            } else if (choice == STAY) { // player decided to stay
-                alignCenter(11);
-                send("You stayed!");
-                fillScreen(SCREENFILL);
-                _delay_ms(DELAY_READ);
-                sendChar(NL);
-                break;
-            } else { // unintended behavior
-                send("ERROR in playTurn()");
-                fillScreen(SCREENFILL);
-                _delay_ms(DELAY_REFRESH);
-                sendChar(NL);
-                break;
-            }
-        }
-        
-    }
-    if (pB->empty) { // player did not split their hand an only has one hand
-        return;
-    }
-    while (1) { // player's turn for their second hand
-        SCREENFILL = TERMHEIGHT;
-        dispUpper(ID);
-        sendChar(NL);
-        alignCenter(23);
-        send("Your current hand: [");
-        char temp[3];
-        itoa(pB->handvalue,temp,10);
-        send(temp);
-        send("]");
-        sendChar(NL);
-        cardPrint(&(*pB));
-        SCREENFILL -= 2;
-        sendChar(NL);
-        sendChar(NL);
-        SCREENFILL -= 2;
-        if (pB->busted) {
-            alignCenter(11);
-            send("You BUSTED!");
-            fillScreen(SCREENFILL);
-            _delay_ms(DELAY_REFRESH);
-            sendChar(NL);
-            break;
-        } else if (pB->handvalue == 21) {
-            alignCenter(16);
-            send("You got TAPJACK!");
-            fillScreen(SCREENFILL);
-            _delay_ms(DELAY_REFRESH + 2000);
-            sendChar(NL);
-            break;
-        } else {
-            alignCenter(12);
-            send("HIT or STAY?");
-            fillScreen(SCREENFILL);
-            int choice = userInput();
-            _delay_ms(DELAY_INPUT);
-            sendChar(NL);
-
-            SCREENFILL = TERMHEIGHT;
-            dispUpper(ID);
-            sendChar(NL);
-            alignCenter(23);
-            send("Your current hand: [");
-            char temp[3];
-            itoa(pB->handvalue,temp,10);
-            send(temp);
-            send("]");
-            sendChar(NL);
-            cardPrint(&(*pB));
-            SCREENFILL -= 2;
-            sendChar(NL);
-            sendChar(NL);
-            SCREENFILL -= 2;
-            if (choice == HIT) {
-                alignCenter(8);
-                send("You hit!");
-                dealCard(&(*pB));
-                fillScreen(SCREENFILL);
-                _delay_ms(DELAY_REFRESH);
-                sendChar(NL);
-            } else if (choice == STAY) {
-                alignCenter(11);
-                send("You stayed!");
-                fillScreen(SCREENFILL);
-                _delay_ms(DELAY_REFRESH);
-                sendChar(NL);
-                break;
-            } else {
-                send("ERROR in playTurn()");
-                fillScreen(SCREENFILL);
-                _delay_ms(DELAY_REFRESH);
-                sendChar(NL);
-                break;
-            }
-        }
-        
-    }
-}
-// deal one available card from the deck to the given player
-// also updates their handsize, handvalue, and other hand characteristics
-void dealCard(hand *p) {
-    if ((indexG >= SINGLEDECK) || (p->handsize >= MAXHAND)) {
-		send("ERROR: Cannot Deal Card!\n");
-		return;
-	}
-	int rank = rankG[indexG];
-	p->rank[p->handsize] = rank;
-	p->suit[p->handsize] = suitG[indexG];
-	p->handsize++;
-	indexG++;
-	switch (rank) {
-		case 1:
-		p->handvalue += 11;
-		p->soft++;
-		break;
-		case 10:
-		case 11:
-		case 12:
-		case 13:
-		p->handvalue += 10;
-		break;
-		default:
-		p->handvalue += rank;
-	}
-	if (p->handvalue > 21) {
-		if (p->soft > 0) {
-			p->handvalue -= 10;
-			p->soft--;
-		}
-		else { p->busted = 1; }
-	}
-    p->empty = 0;
-} 
-// splits given player's hand 
-void split(int ID) {
-    hand *pA, *pB;
-    selectPlayer(ID, &pA, &pB);
-    SCREENFILL = TERMHEIGHT;
-    dispUpper(ID);
-    sendChar(NL);
-    alignCenter(23);
-    send("Your current hand: [");
-    char temp[3];
-    itoa(pA->handvalue,temp,10);
-    send(temp);
-    send("]");
-    sendChar(NL);
-    cardPrint(&(*pA));
-    SCREENFILL -= 2;
-    sendChar(NL);
-    sendChar(NL);
-    SCREENFILL -= 2;
-    alignCenter(10);
-    send("You split!");
-    fillScreen(SCREENFILL);
-    int cardR = pA->rank[1];
-    char cardS = pA->suit[1];
-    pB->rank[0] = cardR;
-    pB->suit[0] = cardS;
-    pB->handsize++;
-    pB->handvalue += cardR;
-    pA->handsize--;
-    pA->handvalue -= cardR;
-    if (cardR == 1) {
-        pB->soft = 1;
-        pB->handvalue = 11;
-        pA->soft = 1;
-        pA->handvalue = 11;
-    }
-    dealCard(&(*pA));
-    dealCard(&(*pB));
-    _delay_ms(DELAY_INPUT);
-    sendChar(NL);
-}
-// wait for user input
-int userInput() {
-    while (USS_move() != NOACTION); // wait for USS input area to be cleared
-	while (1) {
-		/*_delay_ms(DELAY_INPUT);*/
-		switch (USS_move()) {
-			case STAY: return STAY;
-			case HIT: return HIT;
-			case NOACTION: break;
-		}
-	}
-}
-// retrieves given player's hands for modification or display
-// given player *ID*, place their first hand in *pA* and their second hand in *pB*
-void selectPlayer(int ID, hand** pA, hand** pB) {
-    switch (ID) {
-        case P1:
-            *pA = &p1a;
-            *pB = &p1b;
-            break;
-        case P2:
-            *pA = &p2a;
-            *pB = &p2b;
-            break;
-        case P3:
-            *pA = &p3a;
-            *pB = &p3b;
-            break;
-        case P4:
-            *pA = &p4a;
-            *pB = &p4b;
-            break;
-        case DEALER:
-            send("ERROR in selectPlayer()\n");
-            break;
-    }
-}
-// initialize USART protocol for communication between atmega and atmel terminal
-void USART_init(unsigned int ubrr) {
-    //Set baud rate
-	UBRR0H = (unsigned char)(ubrr>>8);
-	UBRR0L = (unsigned char) ubrr;
-	// enable transmitter
-	UCSR0B = (1<<TXEN0);
-	// Set frame format: async, no parity, 1 stop bit, , 8 data bits
-	UCSR0C = (0<<UMSEL01)|(0<<UMSEL00)|(0<<UPM01)|(0<<UPM00)|(0<<USBS0)|(1<<UCSZ01)|(1<<UCSZ00);
-}
-// transmit string to USART channel
-void send(const char* data) {
-    while (*data) {
-		//check if buffer is empty so that data can be written to transmit
-		while (!(UCSR0A & (1 << UDRE0)));
-		UDR0 = *data; //copy data to be sent to UDR0
-		++data;
-	}
-}
-// transmits single character to USART channel
-void sendChar(const char data) {
-    //check if buffer is empty so that data can be written to transmit
-	while (!(UCSR0A & (1 << UDRE0)));
-	UDR0 = data; //copy character to be sent to UDR0
-}
-// initialize ultrasonic sensor for touchless controls
-void USS_init() {
-    /*Ultrasonic Initialization
-	PB0 is the Echo Pin & PB1 is the Trigger*/
-	
-	//Define Pins
-	#define Trigger_pin PB1	//This is the UltraSonic Sensors Trigger Pin
-	
-	//GPIO Programming
-	DDRB = 0x02;	//Output for Ultrasonic Trigger Pin
-	
-	//Timer 1 Initialization
-	TIMSK1 = (1 << TOIE1);	//Enable Timer1 overflow interrupts
-	TCCR1A = 0;				//Set all bit to zero Normal operation
-	
-	//Enable Global Interrupts
-	sei();
-}
-// calculate ultrasonic sensor distance to determine which control was selected
-double USS_distance() {
-    TCCR1B |= (1 << CS10);  //Prescaler, Start Timer
-	
-	/*Declare variables*/
-	long count;				//var to store the received input from ultrasonic
-	double distance;	//var to store the received distance from the USART
-	
-	/*Receive the UltraSonic sensors values*/
-	PORTB |= (1 << Trigger_pin);			//Begin Trigger
-	_delay_us(10);
-	PORTB &= (~(1 << Trigger_pin));			//Cease Trigger
-	TCNT1 = 0;								//Clear Timer counter
-	TCCR1B = (1 << ICES1) | (1 << CS10);	//Capture rising edge, prescaler 1
-	TIFR1 = (1 << ICF1) | (1 << TOV1);		// Clear ICP flag & Clear Timer Overflow flag
-	
-	/*Calculate width of Echo by Timer 1 ICP*/
-	while ((TIFR1 & (1 << ICF1)) == 0);		// Wait for rising edge
-	TCNT1 = 0;								// Clear Timer counter
-	TCCR1B = (1 << CS10);					// Capture falling edge
-	TIFR1 = (1 << ICF1) | (1 << TOV1);		// Clear ICP flag & Clear Timer Overflow flag
-	timerOverflow = 0;						// Clear Timer overflow count
-	while ((TIFR1 & (1 << ICF1)) == 0);		//Wait for falling edge
-	count = ICR1 + (65535 * timerOverflow);	//Take value of capture register and calculate width
-	distance = (double) count / (HCSR04CONST*F_CPU/1000000);		//Calculate Distance
-	
-	TCCR1B ^= (1 << CS10);  //No prescaler, Stop Timer
-	return distance;
-}
-// determine player's move (hit, stay) from ultrasonic sensor distance calculated
-int USS_move() {
-    int countS = 0;
-    int countH = 0;
-    int countN = 0;
-    double distance = USS_distance();
-    while(1) 
-    {
-        /*Determine what the chosen move was*/
-        if (distance > DIST_HIT && distance < (DIST_HIT + WIDTH)) 
-        {		//test for hit
-            countS = countN = 0;	//reset the other move counters
-            countH++;					//increment this moves counter
-            if (countH > THRESHOLD) 
-            {			
-                return HIT;					//HIT
-            }
-        }
-        else if (distance > DIST_STAY && distance < (DIST_STAY + WIDTH)) 
-        {	//test for stay
-            countH = countN = 0;	//reset the other move counters
-            countS++;					//increment this moves counter
-            if (countS > THRESHOLD) 
-            {		
-                return STAY;					//STAY
-            }
-        }
-        else 
-        {										//if not hit or stay, OR if nothings happening
-            countH = countS = 0;	//reset the other move counters
-            countN++;					//increment this moves counter
-            if (countN > THRESHOLD) 
-            {		
-                return NOACTION;					//NOACTION
-            }
-        }
-        _delay_ms(1);
-    }
-}
+// TAPjack source code
+// last modified 4/19/2024
+// ASCII cards designed by Kevin Lei
+// Ultrasonic Sensor functions designed by Quinn Frady
+// game logic and screen display functions designed by Nathan Ramos
+
+// for USART
+#define F_CPU 8000000UL
+#ifndef BAUD
+#define BAUD 38400 // link speed after reset, 250000, 500000 and 1000000 are exact at 8 MHz
+#endif
+#ifndef BAUD_FAST
+#define BAUD_FAST 0 // speed offered to the terminal by USART_upgrade(), 0 = stay at BAUD
+#endif
+#define BAUD_TOL 20 // most baud rate error the receiver can take, in 1/1000
+// UBRR value, real speed and error in 1/1000 for speed b, x2 = double speed mode (U2X0)
+#define UBRR_FOR(b, x2) ((F_CPU + 4UL * (2 - (x2)) * (b)) / (8UL * (2 - (x2)) * (b)) - 1)
+#define BAUD_FOR(b, x2) (F_CPU / (8UL * (2 - (x2)) * (UBRR_FOR(b, x2) + 1)))
+#define BAUD_ERR(b, x2) ((BAUD_FOR(b, x2) > (b) ? BAUD_FOR(b, x2) - (b) : (b) - BAUD_FOR(b, x2)) * 1000 / (b))
+// double speed halves the receiver's sampling, so it is only used when it is more accurate
+#if BAUD_ERR(BAUD, 1) < BAUD_ERR(BAUD, 0)
+#define BAUD_2X 1
+#else
+#define BAUD_2X 0
+#endif
+#if BAUD_ERR(BAUD, BAUD_2X) > BAUD_TOL
+#error "BAUD cannot be reached from F_CPU within BAUD_TOL"
+#endif
+#define MYUBRR UBRR_FOR(BAUD, BAUD_2X)
+#if BAUD_FAST
+#if BAUD_ERR(BAUD_FAST, 1) < BAUD_ERR(BAUD_FAST, 0)
+#define BAUD_FAST_2X 1
+#else
+#define BAUD_FAST_2X 0
+#endif
+#if BAUD_ERR(BAUD_FAST, BAUD_FAST_2X) > BAUD_TOL
+#error "BAUD_FAST cannot be reached from F_CPU within BAUD_TOL"
+#endif
+#endif
+#define TX_BUFSIZE 64 // transmit ring buffer size, must be a power of two
+#define TX_BLOCKS 4 // blocks that can wait to be streamed by USART_UDRE_vect, must be a power of two
+#define ASCII_NUM 48
+// for USS
+#define HCSR04CONST 582 // echo time in us per 100 mm of distance
+#define GESTURE_WINDOW 5 // most recent samples the gesture classifier looks at
+#define GESTURE_CONFIDENCE 3 // samples in the window that must agree before a move is reported
+#define WIDTH 220 // mm
+#define DIST_HIT 80 // mm
+#define DIST_STAY 350 // mm
+#define Trigger_pin PB1 // This is the UltraSonic Sensors Trigger Pin
+#ifndef NUMSENSORS
+#define NUMSENSORS 1 // ultrasonic sensors, seat n reads sensor (n - 1) % NUMSENSORS, one per seat stops the turns waiting on each other
+#endif
+// sensor 0 triggers on PB1 and echoes on PB0 (ICP1), sensor s triggers on PB1 + s and echoes on PD3 + s (PCINT2)
+#define USS_ECHO(s) (PD3 + (s)) // echo pin on PORTD of sensors 1 and up
+#define USS_TRIGGERS (((1 << NUMSENSORS) - 1) << Trigger_pin) // every trigger pin on PORTB
+#define USS_SLOTS 4 // sensors take turns in this many slots per Timer1 period, must be a power of two
+#define USS_SLOT (65536UL / USS_SLOTS) // ticks between triggers, 16 ms, an echo that matters is back in 4
+#define USS_PRESCALE 8 // Timer1 prescaler, 1 tick = 1 us at 8 MHz
+#define USS_TRIGGER 12 // trigger pulse length in timer ticks, sensor needs at least 10 us
+#define USS_TICKS(mm) ((mm) * (unsigned long) HCSR04CONST * (F_CPU/USS_PRESCALE/1000000) / 100) // distance in mm to echo width in timer ticks
+#define USS_QUEUE 8 // echo samples kept per sensor for USS_read(), must be a power of two
+#define USS_IDLE 0 // no echo expected
+#define USS_RISE 1 // waiting for echo to start
+#define USS_FALL 2 // waiting for echo to end
+// card art
+#define CARDROWS 10 // lines per card
+#define CARDWIDTH 14 // chars per card
+#define ART_HEARTS 0 // suit rows are indexed by cardSuit()
+#define ART_DIAMONDS 1
+#define ART_CLUBS 2
+#define ART_SPADES 3
+#define ART_ERROR 4 // cardSuit() of an index past the deck
+#define ART_BACK 5
+//display config
+// For 150% Display scale: 37 char terminal height, hide task bar
+// For 175% display scaling: 28x165, hide task bar
+#define TERMHEIGHT 28
+#define TERMWIDTH 165
+#define ESC 0x1B // starts ANSI escape sequences
+#define RUN_MIN 5 // shortest run of blanks worth replacing with a cursor-forward sequence
+#define BLOCK_MIN 4 // shortest stretch of flash text worth a block descriptor, shorter ones are copied into the ring
+#define TERM_DETECT_MS 250 // how long to wait for the terminal to answer a cursor position request
+#ifndef EVENTS
+#define EVENTS 1 // true = offer a host front end the event stream at reset, see events.h
+#endif
+// scheduler
+#define TICK_OCR (F_CPU/64/1000 - 1) // Timer0 compare value for a 1 ms tick at prescaler 64
+// profiling
+#ifndef PROFILE
+#define PROFILE 1 // true = time subsystems and watch the stack, '?' from the terminal shows the numbers
+#endif
+#define KEY_PROFILE '?' // terminal key for the profile screen
+#define KEY_STATS 's' // terminal key for the table stats screen
+#define PROF_RENDER 0 // drawing game screens
+#define PROF_ENGINE 1 // gameStep()
+#define PROF_SENSOR 2 // taskSensor()
+#define PROF_TXWAIT 3 // USART_put() waiting for ring space
+#define PROF_N 4
+#define STACK_PAINT 0xC5 // fills unused SRAM at reset, whatever still holds it was never touched by the stack
+#if PROFILE
+#define PROF_START(v) unsigned long v = profNow()
+#define PROF_STOP(id, v) profAdd(id, v)
+#else
+#define PROF_START(v)
+#define PROF_STOP(id, v)
+#endif
+// table stats kept in an EEPROM ring, 's' from the terminal shows them
+#define STATS_MAGIC (0xA0 + NUMSEATS) // first byte of every record, a log written for another seat count is ignored
+#define STATS_SLOTS ((int) ((E2END + 1) / sizeof(statsRecord))) // records in the ring, each slot is written once per lap, an int like the slot arithmetic it is compared with
+// delays
+#define DELAY_INPUT 200
+#define DELAY_FAST 500 // dealer screens of a round that is already settled
+#define DELAY_REFRESH 2000
+#define DELAY_READ 4000
+#define DELAY_RESULTS 10000
+// advice
+#define SHOW_ADVICE 1 // true = question screens show what basic strategy would do
+#define ADVICE_LEN 64 // room for the advice text, the longest is 54 chars
+#define AUTOPLAY_MS 20000 // question left unanswered this long is played by the advice, 0 = wait forever
+
+// DO NOT CHANGE
+#define NL '\n'
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "engine.h"
+#include "strategy.h"
+#include "screens.h"
+#include "events.h"
+
+#if STRATEGY_SOFT17 != HIT_SOFT17
+#error "strategy.h was generated for other dealer rules, run make tables in sim/"
+#endif
+#if SCREEN_WIDTH != TERMWIDTH
+#error "screens.h was centered for another terminal width, run make screens TERMWIDTH=... in sim/"
+#endif
+#if NUMSEATS > 9
+#error "player numbers are drawn as one digit"
+#endif
+#if NUMSENSORS < 1 || NUMSENSORS > USS_SLOTS
+#error "NUMSENSORS must be from 1 to USS_SLOTS"
+#endif
+
+// ASCII card art kept in flash, one entry per card line
+// @ shows where rankMark[] puts the card's rank
+const char cardArt[ART_BACK + 1][CARDROWS][CARDWIDTH + 1] PROGMEM = {
+	{ // hearts
+		" +-----------+", " | @         |", " |           |",
+		" |    _ _    |", " |   ( V )   |", " |    \\ /    |", " |     V     |",
+		" |           |", " |         @ |", " +-----------+"
+	},
+	{ // diamonds
+		" +-----------+", " | @         |", " |           |",
+		" |     ^     |", " |    / \\    |", " |    \\ /    |", " |     V     |",
+		" |           |", " |         @ |", " +-----------+"
+	},
+	{ // clubs
+		" +-----------+", " | @         |", " |           |",
+		" |     _     |", " |    (&)    |", " |   (&&&)   |", " |     ^     |",
+		" |           |", " |         @ |", " +-----------+"
+	},
+	{ // spades
+		" +-----------+", " | @         |", " |           |",
+		" |     .     |", " |    /&\\    |", " |   (&&&)   |", " |     ^     |",
+		" |           |", " |         @ |", " +-----------+"
+	},
+	{ // unknown suit
+		" +-----------+", " | @         |", " |           |",
+		" |   ERROR   |", " |   ERROR   |", " |   ERROR   |", " |   ERROR   |",
+		" |           |", " |         @ |", " +-----------+"
+	},
+	{ // face down
+		" +-----------+", " |###########|", " |####   ####|",
+		" |#### U ####|", " |#### N ####|", " |#### L ####|", " |#### V ####|",
+		" |####   ####|", " |###########|", " +-----------+"
+	}
+};
+
+// column of the rank in each card line, 0 = line has no rank
+const unsigned char rankMark[CARDROWS] PROGMEM = { 0, 3, 0, 0, 0, 0, 0, 0, 11, 0 };
+// char printed for each rank, Ace to King
+const char rankGlyph[MAXSUIT] PROGMEM = "A23456789TJQK";
+
+typedef struct gesture {
+	unsigned char zone[GESTURE_WINDOW]; // move zone (HIT, STAY, NOACTION) of each sample in the window
+	unsigned char count[NOACTION + 1]; // how many samples in the window fall in each zone
+	unsigned char next; // position in zone[] the next sample replaces
+	unsigned char filled; // samples in the window so far
+	} gesture;
+
+typedef struct task {
+	void (*run)(); // does a small piece of work and returns
+	unsigned int period; // ms between runs, 0 = every pass
+	unsigned int due; // tick when task runs next
+	unsigned char busy; // true while the task is running, it is not started again until it returns
+	} task;
+
+typedef struct screen {
+	void (*draw)(PGM_P msg); // draws the screen for a game state
+	PGM_P msg; // message shown under the cards, if the screen has one
+	unsigned int hold; // ms the screen stays up before the round moves on, 0 = until HIT or STAY
+	} screen;
+
+typedef struct seatStats {
+	uint16_t wins; // hands, a split seat counts both
+	uint16_t losses;
+	uint16_t pushes;
+	uint16_t splits; // pairs split
+	} seatStats;
+
+typedef struct statsRecord {
+	uint8_t magic; // STATS_MAGIC
+	uint16_t seq; // one more than the record before it, the newest valid record holds the totals
+	uint16_t rounds; // rounds played to the end
+	seatStats seats[NUMSEATS];
+	uint8_t check; // makes the bytes of the record add up to 0
+	} statsRecord;
+
+typedef struct txBlock {
+	const char *data; // next byte of the block
+	unsigned char len; // bytes of the block still to send
+	unsigned char flash; // true = data is stored in flash
+	unsigned char at; // txHead when the block was queued, it goes out once the ring has been sent up to there
+	} txBlock;
+
+// global vars
+volatile unsigned char txBuf[TX_BUFSIZE]; // bytes waiting to be sent by USART_UDRE_vect
+volatile unsigned char txHead = 0; // next free slot in txBuf
+volatile unsigned char txTail = 0; // next byte to be transmitted
+volatile txBlock txBlocks[TX_BLOCKS]; // blocks streamed straight from their source, in between ring bytes
+volatile unsigned char blkHead = 0; // next free slot in txBlocks
+volatile unsigned char blkTail = 0; // block being sent or next to be sent
+
+char line[TERMWIDTH]; // line currently being drawn
+unsigned char lineLen = 0; // chars in line
+unsigned char termRow = 0; // terminal row line will be drawn on, lines past TERMHEIGHT are dropped
+unsigned long rowSum[TERMHEIGHT]; // checksum of what each terminal row is showing, 0 = blank
+int termAnsi = 0; // true = terminal understands ANSI escapes, false = dumb terminal, screens are scrolled
+int termEvents = 0; // true = a host front end draws the game from event packets, no screens are sent
+uint16_t evSum[EV_HANDS]; // checksum of each hand as last sent, a hand is only sent again once it changes
+char advice[ADVICE_LEN]; // advice line being drawn, kept off the stack like every buffer, see bench/Makefile budget
+volatile unsigned int ussQueue[NUMSENSORS][USS_QUEUE]; // echo widths in timer ticks, oldest is dropped when full
+volatile unsigned char ussHead[NUMSENSORS]; // next free slot in ussQueue
+volatile unsigned char ussTail[NUMSENSORS]; // oldest sample in ussQueue
+volatile unsigned char ussState[NUMSENSORS]; // where each sensor's echo capture state machine is
+volatile unsigned int echoStart[NUMSENSORS]; // timer value when echo started
+volatile unsigned char ussSlot = 0; // trigger slot TIMER1_COMPB_vect starts next
+gesture ussGesture[NUMSENSORS]; // classifies samples from each ultrasonic sensor into moves
+int lastMove[NUMSENSORS]; // latest move reported by each gesture classifier
+unsigned char moveSeq[NUMSENSORS]; // incremented every time a gesture classifier reports a move
+int earlyMove[NUMSENSORS]; // move made at a sensor before its seat's turn, ERROR = none
+unsigned char earlyCleared[NUMSENSORS]; // hand has left that sensor since, so the next move counts
+volatile unsigned long adcPool = 0; // light sensor noise mixed in by ADC_vect, reseeds the engine's PRNG
+
+volatile unsigned int msTicks = 0; // milliseconds since power on, wraps every 65 s
+
+int playing = 0; // true once the intro is over and taskGame runs the rounds
+unsigned int screenStart; // tick when the current game screen went up
+unsigned int screenHold; // ms the current game screen stays up
+unsigned char gameMoveSeq; // moveSeq of the playing seat's sensor last seen by taskGame
+int gameCleared; // true = hand has left the sensor since the current game screen went up
+unsigned char engineErr = 0; // last ERR_* from the engine, shown on the next screen
+
+volatile unsigned int t1Overflows = 0; // Timer1 overflows, high word of profNow()
+unsigned long profTicks[PROF_N]; // Timer1 ticks (8 cycles) spent in each subsystem, nested time is counted in both
+unsigned int profCalls[PROF_N]; // times each subsystem ran
+unsigned long txQueued = 0; // bytes handed to the transmit path since reset
+unsigned long frameStart; // txQueued when the current frame began
+unsigned int frameBytes = 0; // bytes the last frame sent
+unsigned int frameMax = 0; // most bytes any frame sent
+unsigned int keyShown; // tick a screen asked for from the terminal went up, 0 = game screen is showing
+statsRecord stats; // table totals, logged to EEPROM after every round
+statsRecord statsOut; // sealed copy of the totals EE_READY_vect is writing, stats can change under it
+volatile unsigned char statsSlot = 0; // ring slot the next record goes to
+volatile unsigned char statsPos = 0; // bytes of the record EE_READY_vect has written so far
+volatile unsigned char statsPending = 0; // true = totals changed while a record was being written
+
+// display logic
+void cardPrint(hand *p); // print entire hand
+char rankConvert(card c);
+void frameBlank(unsigned char lines); // emit blank lines
+void alignCenter(int strWidth); // displays a line of strings that is centered
+void dispUpper(int ID); // prints everything from the dealer's hand upwards
+void dispIntro(); // display welcome greeting & credits
+void dispBlank(); // display blank screen
+void dispRound(int round); // display round screen
+void dispTurn(int ID); // display turn screen
+void dispResults(); // decides win or push or loss
+void dispHand(PGM_P msg); // display active hand with a message
+void dispDealer(PGM_P msg); // display dealer's hand with a message
+void adviceText(char *adv); // advice for the current question
+void dispDealerStay(PGM_P msg); // display dealer's final hand value
+void drawRound(PGM_P msg); // game screen for ST_ROUND
+void drawTurn(PGM_P msg); // game screen for ST_TURN
+void drawResults(PGM_P msg); // game screen for ST_RESULTS
+PGM_P resultText(int result); // result of a hand in words
+
+// terminal renderer
+void termInit(); // clear terminal and screen model
+void frameBegin(); // start drawing a screen from the top row
+void frameEnd(); // blank the rest of the screen
+void frameCount(); // note bytes sent by the frame
+void termLine(); // draw finished line if its row changed
+void termCursor(unsigned char row); // move cursor to start of row
+void termEsc(unsigned char n, char cmd); // send ANSI escape with one numeric parameter
+void frameScreen_P(PGM_P screen, const char *field); // draw a compressed screen from screens.h
+PGM_P screenRow(PGM_P row, const char *field, unsigned int *sumA, unsigned int *sumB, unsigned char draw); // checksum or draw one screen row
+int termDetect(); // ask terminal whether it understands ANSI escapes
+
+// event stream
+int eventDetect(); // offer the event stream to a host front end
+void eventShow(unsigned char state); // send what changed as the round entered state
+void eventHand(unsigned char id, hand *p); // send a hand if it changed
+void eventSeed(unsigned long noise); // record noise mixed into the PRNG
+void eventInput(unsigned char state, int input, unsigned int ms); // record an answer to a question
+void eventSend(unsigned char type, const unsigned char *data, unsigned char len); // send one packet
+
+// reset logic
+void ADC_init(); // sample light sensor noise in the background
+unsigned long ADC_pool(); // light sensor noise gathered so far
+
+// game logic
+void taskGame(); // run the round's state machine
+int gameKeys(); // show the profile or stats screen when asked for, between states
+void gameShow(unsigned char state); // draw screen for a state
+int adviceFor(hand *p, card up, int splitOffer); // basic strategy HIT or STAY
+
+// USART
+void USART_init(unsigned int ubrr, unsigned char x2); // init USART, x2 = double speed
+void send(const char* data); // send string
+void sendChar(const char data); // send char
+void USART_put(const char data); // queue char, wait while buffer is full
+void USART_send_P(PGM_P data); // queue string stored in flash
+void send_P(PGM_P data); // send string stored in flash
+int USART_tryPut(const char data); // queue char without waiting
+void USART_block(const char *data, unsigned char len, unsigned char flash); // queue block to be sent from where it is
+void USART_flush(); // wait for transmit buffer to drain
+int USART_tryGet(); // read received char without waiting
+int USART_wait(char c, unsigned int ms); // wait for a given char to arrive
+int USART_upgrade(); // offer BAUD_FAST to the terminal
+
+// UltraSonicSensor
+void USS_init(); // init USS
+void USS_push(unsigned char s, unsigned int ticks); // queue an echo sample, called from the capture interrupts
+int USS_read(unsigned char s, unsigned int *ticks); // get echo sample without waiting
+void USS_clear(unsigned char s); // discard queued echo samples
+int USS_zone(unsigned int ticks); // which move a distance falls in
+unsigned char seatSensor(int ID); // sensor a seat plays with
+
+// gesture classifier
+void gestureReset(gesture *g); // forget all samples
+int gestureFeed(gesture *g, int zone); // add one sample, get move once confident
+
+// scheduler
+void SCHED_init(); // init 1 ms tick
+unsigned int SCHED_now(); // current tick
+void SCHED_poll(); // run tasks that are due
+void hold(unsigned int ms); // keep screen up, gesture skips
+void taskSensor(); // feed ultrasonic samples to the gesture classifier
+
+// profiling
+unsigned long profNow(); // free running Timer1 ticks
+void profAdd(unsigned char id, unsigned long start); // count time since start against a subsystem
+unsigned int stackUnused(); // SRAM bytes the stack never reached
+void dispProfile(); // display the profile screen
+
+// stats log
+void statsInit(); // carry on from the newest record in the EEPROM log
+void statsRound(); // count the round that just ended and log it
+void statsCount(uint16_t *n); // add one, stopping at the limit instead of wrapping
+void statsWrite(); // start writing the totals to the next slot
+unsigned char eepromRead(unsigned int addr); // read one byte of EEPROM
+void dispStats(); // display the stats screen
+
+task tasks[] = {
+	{ taskSensor, 0, 0, 0 },
+	{ taskGame, 0, 0, 0 },
+};
+#define NUMTASKS (sizeof(tasks) / sizeof(tasks[0]))
+
+// messages shown under the cards
+const char msgSplit[] PROGMEM = "SPLIT? (HIT for YES) (STAY for NO)";
+const char msgSplitting[] PROGMEM = "You split!";
+const char msgAction[] PROGMEM = "HIT or STAY?";
+const char msgHit[] PROGMEM = "You hit!";
+const char msgStay[] PROGMEM = "You stayed!";
+const char msgBust[] PROGMEM = "You BUSTED!";
+const char msgTapjack[] PROGMEM = "You got TAPJACK!";
+const char msgDealerHit[] PROGMEM = "Dealer hits!";
+const char msgDealerBust[] PROGMEM = "Dealer BUSTED!";
+const char msgDealerSkip[] PROGMEM = "Every hand BUSTED!";
+
+// what the terminal shows in each game state
+const screen screens[NUMSTATES] PROGMEM = {
+	[ST_ROUND]       = { drawRound, 0, DELAY_REFRESH },
+	[ST_TURN]        = { drawTurn, 0, DELAY_REFRESH },
+	[ST_SPLIT]       = { dispHand, msgSplit, 0 },
+	[ST_SPLITTING]   = { dispHand, msgSplitting, DELAY_INPUT },
+	[ST_ACTION]      = { dispHand, msgAction, 0 },
+	[ST_HIT]         = { dispHand, msgHit, DELAY_REFRESH },
+	[ST_STAY]        = { dispHand, msgStay, DELAY_READ },
+	[ST_BUST]        = { dispHand, msgBust, DELAY_READ },
+	[ST_TAPJACK]     = { dispHand, msgTapjack, DELAY_READ },
+	[ST_DEALER]      = { dispDealer, 0, DELAY_REFRESH },
+	[ST_DEALER_HIT]  = { dispDealer, msgDealerHit, DELAY_REFRESH },
+	[ST_DEALER_STAY] = { dispDealerStay, 0, DELAY_READ },
+	[ST_DEALER_BUST] = { dispDealer, msgDealerBust, DELAY_READ },
+	[ST_DEALER_SKIP] = { dispDealer, msgDealerSkip, DELAY_READ },
+	[ST_RESULTS]     = { drawResults, 0, DELAY_RESULTS },
+	[ST_OVER]        = { 0, 0, 0 },
+};
+
+// interrupt subroutine for the 1 ms scheduler tick
+ISR(TIMER0_COMPA_vect)
+{
+	msTicks++;
+}
+
+// interrupt subroutine for counting Timer1 overflows, every 65.5 ms
+ISR(TIMER1_OVF_vect)
+{
+	t1Overflows++;
+}
+
+// interrupt subroutine for starting the next sensor's trigger pulse
+// every sensor gets one of the USS_SLOTS slots in each Timer1 period, so each still pings every 65.5 ms
+// with time for the longest echo (38 ms) to come back, and only one ping at a time is in the air
+ISR(TIMER1_COMPB_vect)
+{
+	unsigned char s = ussSlot;
+	ussSlot = (s + 1) & (USS_SLOTS - 1);
+	OCR1B += USS_SLOT;						// next slot
+	if (s >= NUMSENSORS) { return; }		// slot has no sensor
+	PORTB |= (1 << (Trigger_pin + s));		// Begin Trigger
+	OCR1A = TCNT1 + USS_TRIGGER;			// end trigger from TIMER1_COMPA_vect
+	TIFR1 = (1 << OCF1A);					// Clear compare flag
+	TIMSK1 |= (1 << OCIE1A);
+	if (s == 0) {
+		TCCR1B |= (1 << ICES1);				// Capture rising edge
+		TIFR1 = (1 << ICF1);				// Clear ICP flag
+	}
+	ussState[s] = USS_RISE;
+}
+
+// interrupt subroutine for ending the ultrasonic trigger pulse
+ISR(TIMER1_COMPA_vect)
+{
+	PORTB &= ~USS_TRIGGERS;					// Cease Trigger
+	TIMSK1 &= ~(1 << OCIE1A);
+}
+
+// interrupt subroutine for timestamping both edges of sensor 0's echo
+ISR(TIMER1_CAPT_vect)
+{
+	if (ussState[0] == USS_RISE) {
+		echoStart[0] = ICR1;
+		TCCR1B &= ~(1 << ICES1);			// Capture falling edge
+		TIFR1 = (1 << ICF1);				// edge change can set ICF1, clear it
+		ussState[0] = USS_FALL;
+	} else if (ussState[0] == USS_FALL) {
+		USS_push(0, ICR1 - echoStart[0]);	// width of echo, correct across one wrap of TCNT1
+		ussState[0] = USS_IDLE;
+	}
+}
+
+#if NUMSENSORS > 1
+// interrupt subroutine for timestamping the echoes of sensors 1 and up, which have no capture pin
+// TCNT1 is read first, so a width is only off by this interrupt's latency, a few us
+ISR(PCINT2_vect)
+{
+	unsigned int now = TCNT1;
+	unsigned char pins = PIND;
+	for (unsigned char s = 1; s < NUMSENSORS; s++) {
+		unsigned char high = pins & (1 << USS_ECHO(s));
+		if (ussState[s] == USS_RISE && high) {
+			echoStart[s] = now;
+			ussState[s] = USS_FALL;
+		} else if (ussState[s] == USS_FALL && !high) {
+			USS_push(s, now - echoStart[s]);
+			ussState[s] = USS_IDLE;
+		}
+	}
+}
+#endif
+
+// interrupt subroutine for a finished light sensor conversion
+// Timer0's compare match starts one every ms, only the noisy low bits matter
+ISR(ADC_vect)
+{
+	adcPool = ((adcPool << 5) | (adcPool >> 27)) ^ ADC;
+}
+
+// interrupt subroutine for feeding the USART from the transmit buffer
+ISR(USART_UDRE_vect)
+{
+	if (blkHead != blkTail && txBlocks[blkTail].at == txTail) { // block is due before the rest of the ring
+		volatile txBlock *b = &txBlocks[blkTail];
+		UDR0 = b->flash ? pgm_read_byte(b->data) : *b->data;
+		b->data++;
+		if (--b->len == 0) { blkTail = (blkTail + 1) & (TX_BLOCKS - 1); }
+		return;
+	}
+	if (txHead == txTail) { // nothing left to send
+		UCSR0B &= ~(1 << UDRIE0); // disable data register empty interrupt
+		return;
+	}
+	UDR0 = txBuf[txTail]; // copy next byte to be sent to UDR0
+	txTail = (txTail + 1) & (TX_BUFSIZE - 1);
+}
+
+// interrupt subroutine for the EEPROM turning ready again
+// writes the stats record a byte per interrupt, each byte takes the EEPROM about 3.4 ms
+// so a record goes down in the background and nothing ever waits for the EEPROM
+ISR(EE_READY_vect)
+{
+	if (statsPos < sizeof(statsRecord)) {
+		EEAR = statsSlot * sizeof(statsRecord) + statsPos;
+		EEDR = ((unsigned char *) &statsOut)[statsPos++];
+		EECR |= (1 << EEMPE);
+		EECR |= (1 << EEPE); // has to follow EEMPE within 4 cycles, interrupts are off in here
+		return;
+	}
+	EECR &= ~(1 << EERIE); // record is down
+	statsSlot = statsSlot + 1 < STATS_SLOTS ? statsSlot + 1 : 0;
+	if (statsPending) { statsWrite(); }
+}
+
+int main() {
+    // initialize USART
+	USART_init(MYUBRR, BAUD_2X);
+	// initialize scheduler tick
+	SCHED_init();
+	// initialize USS
+	USS_init();
+	// clear terminal
+	termInit();
+	// initialize deck of cards
+	initDeck();
+	// carry on the table stats from the EEPROM log
+	statsInit();
+    // start gathering light sensor noise, the first round seeds from it
+    ADC_init();
+
+    if (!termEvents) { // a host front end has its own intro
+        dispBlank(); // display blank screen
+        dispIntro(); // display introduction screen
+        dispBlank(); // display blank screen
+    }
+
+    // game runs for 999 rounds, taskGame plays them out
+    gameStart();
+    gameShow(game.state);
+    playing = 1;
+    while (1) {
+        SCHED_poll();
+    }
+}
+// displays entire hand of given player
+// each card's art and rank are looked up once, then every line is copied straight into the line buffer
+void cardPrint(hand *p) {
+    PGM_P art[MAXHAND];
+    char glyph[MAXHAND];
+    uint8_t numCards = p->handsize;
+    for (uint8_t k = 0; k < numCards; k++) {
+        card c = p->cards[k];
+        art[k] = (PGM_P)cardArt[(c & CARD_DOWN) ? ART_BACK : cardSuit(c)];
+        glyph[k] = (c & CARD_DOWN) ? 0 : rankConvert(c); // face down art has no rank
+    }
+    for (uint8_t row = 0; row < CARDROWS; row++) {
+        alignCenter(numCards*CARDWIDTH);
+        uint8_t mark = pgm_read_byte(&rankMark[row]);
+        for (uint8_t k = 0; k < numCards; k++) {
+            uint8_t n = TERMWIDTH - lineLen;
+            if (n > CARDWIDTH) { n = CARDWIDTH; } // clip at right edge
+            memcpy_P(line + lineLen, art[k] + row*(CARDWIDTH + 1), n);
+            if (mark && glyph[k] && mark < n) { line[lineLen + mark] = glyph[k]; }
+            lineLen += n;
+        }
+        termLine();
+    }
+}
+// Converts a card to the char for its rank
+char rankConvert(card c) {
+	return pgm_read_byte(&rankGlyph[cardRank(c) - 1]);
+}
+// emits blank lines, which cost nothing on rows the terminal already shows blank
+void frameBlank(unsigned char lines) {
+    for (;lines > 0; lines--) {
+        termLine();
+    }
+}
+// center-justifies text on the screen
+void alignCenter(int strWidth) {
+    int pad = (TERMWIDTH - strWidth)/2;
+    if (pad > TERMWIDTH - lineLen) { pad = TERMWIDTH - lineLen; }
+    if (pad > 0) {
+        memset(line + lineLen, ' ', pad);
+        lineLen += pad;
+    }
+}
+// clears the terminal and forgets what was on it
+void termInit() {
+	USART_upgrade();
+	termEvents = eventDetect();
+	if (termEvents) { // host draws everything, the terminal model is never used
+		unsigned char hello[3] = { EV_VERSION, NUMSEATS, SEATHANDS };
+		eventSend(EV_HELLO, hello, sizeof(hello));
+		return;
+	}
+	termAnsi = termDetect();
+	if (termAnsi) {
+		USART_send_P(PSTR("\x1B[2J\x1B[?25l")); // clear screen, hide cursor
+	}
+	memset(rowSum, 0, sizeof(rowSum));
+	frameBegin();
+}
+// sends an ANSI cursor position request and waits for the reply (ESC [ row ; col R)
+// dumb terminals never answer, so they get plain scrolled screens instead
+int termDetect() {
+	while (USART_tryGet() >= 0); // discard anything already received
+	USART_send_P(PSTR("\x1B[6n"));
+	return USART_wait('R', TERM_DETECT_MS);
+}
+// starts drawing a new screen from the top row
+// every NL emits one line and moves down a row, so screens never count their own lines
+// only rows that differ from what the terminal already shows get sent
+void frameBegin() {
+	frameStart = txQueued;
+	termRow = 0;
+	lineLen = 0;
+}
+// finishes the screen by blanking every row that was not drawn
+void frameEnd() {
+	if (lineLen > 0) { termLine(); }
+	if (!termAnsi) { // pad with empty lines like a full reprint
+		while (termRow < TERMHEIGHT) { termLine(); }
+		frameCount();
+		return;
+	}
+	// clear every leftover row with one clear-to-end-of-screen
+	for (unsigned char row = termRow; row < TERMHEIGHT; row++) {
+		if (rowSum[row] != 0) {
+			termCursor(row);
+			USART_send_P(PSTR("\x1B[J"));
+			memset(&rowSum[row], 0, (TERMHEIGHT - row) * sizeof(rowSum[0]));
+			break;
+		}
+	}
+	termRow = TERMHEIGHT;
+	frameCount();
+}
+// remembers how many bytes the frame that just ended sent
+void frameCount() {
+	unsigned long n = txQueued - frameStart;
+	frameBytes = n > 0xFFFF ? 0xFFFF : n;
+	if (frameBytes > frameMax) { frameMax = frameBytes; }
+}
+// sends finished line to its terminal row unless that row already shows it
+// runs of blanks inside a line are skipped over with cursor-forward sequences
+void termLine() {
+	unsigned char len = lineLen;
+	unsigned int sumA = 0, sumB = 0;
+	while (len > 0 && line[len - 1] == ' ') { len--; } // trailing blanks are never drawn
+	if (termRow >= TERMHEIGHT) { // frame is taller than the terminal, clip instead of scrolling the top away
+		lineLen = 0;
+		return;
+	}
+	if (!termAnsi) { // dumb terminal, line is always sent
+		for (unsigned char i = 0; i < len; i++) { USART_put(line[i]); }
+		USART_put(NL);
+		termRow++;
+		lineLen = 0;
+		return;
+	}
+	for (unsigned char i = 0; i < len; i++) { // Fletcher checksum of row contents
+		sumA += (unsigned char) line[i];
+		sumB += sumA;
+	}
+	unsigned long sum = ((unsigned long) sumB << 16) | sumA;
+	if (rowSum[termRow] != sum) {
+		rowSum[termRow] = sum;
+		termCursor(termRow);
+		USART_send_P(PSTR("\x1B[2K")); // clear row so skipped blanks show as blank
+		for (unsigned char i = 0; i < len;) {
+			unsigned char run = 0;
+			while (line[i + run] == ' ') { run++; } // line never ends in a blank
+			if (run >= RUN_MIN) {
+				termEsc(run, 'C');
+				i += run;
+			} else if (run > 0) {
+				for (; run > 0; run--, i++) { USART_put(' '); }
+			} else {
+				USART_put(line[i++]);
+			}
+		}
+	}
+	termRow++;
+	lineLen = 0;
+}
+// draws a screen made by sim/tapscreens straight from flash, a row at a time
+// each row is checked against the terminal like termLine() does, by the same checksum, and only a changed
+// row is sent: its text and the copies of earlier text go out through USART_block() from where they are stored
+void frameScreen_P(PGM_P screen, const char *field) {
+	unsigned char c;
+	if (lineLen > 0) { termLine(); } // a screen always starts a row of its own
+	while ((c = pgm_read_byte(screen)) != SCR_END) {
+		if (c == SCR_ROWS) {
+			frameBlank(pgm_read_byte(screen + 1));
+			screen += 2;
+			continue;
+		}
+		unsigned int sumA = 0, sumB = 0;
+		PGM_P next = screenRow(screen, field, &sumA, &sumB, 0);
+		if (termRow >= TERMHEIGHT) { // clipped like termLine()
+			screen = next;
+			continue;
+		}
+		if (!termAnsi) {
+			screenRow(screen, field, &sumA, &sumB, 1);
+			USART_put(NL);
+		} else {
+			unsigned long sum = ((unsigned long) sumB << 16) | sumA;
+			if (rowSum[termRow] != sum) {
+				rowSum[termRow] = sum;
+				termCursor(termRow);
+				USART_send_P(PSTR("\x1B[2K")); // clear row so skipped blanks show as blank
+				screenRow(screen, field, &sumA, &sumB, 1);
+			}
+		}
+		termRow++;
+		screen = next;
+	}
+}
+// walks one row of a screen, returns where the next row starts
+// with draw = 0 it adds the row's chars to the Fletcher sums termLine() takes, with draw = 1 it sends the row:
+// blank runs as cursor moves or spaces, text and copies as blocks, the field through the ring since it is in SRAM
+// rows are never wider than the terminal and never end in blanks, sim/tapscreens makes sure of both
+PGM_P screenRow(PGM_P row, const char *field, unsigned int *sumA, unsigned int *sumB, unsigned char draw) {
+	unsigned char c;
+	while ((c = pgm_read_byte(row)) != NL && c != SCR_END) {
+		PGM_P text;
+		unsigned char len = 0;
+		if (c & SCR_RUN) { // run of blanks
+			len = c & ~SCR_RUN;
+			row++;
+			if (draw) {
+				if (termAnsi && len >= RUN_MIN) { termEsc(len, 'C'); }
+				else { for (c = len; c > 0; c--) { USART_put(' '); } }
+				continue;
+			}
+			for (c = len; c > 0; c--) {
+				*sumA += ' ';
+				*sumB += *sumA;
+			}
+			continue;
+		}
+		if (c == SCR_FIELD) {
+			row++;
+			for (const char *f = field; f && *f; f++) {
+				if (draw) { USART_put(*f); }
+				else {
+					*sumA += (unsigned char) *f;
+					*sumB += *sumA;
+				}
+			}
+			continue;
+		}
+		if ((c & 0xF0) == SCR_COPY) { // repeat of text earlier in the screen
+			text = row - pgm_read_byte(row + 1);
+			len = (c & 0x0F) + SCR_COPY_MIN;
+			row += 2;
+		} else { // chars drawn as themselves, up to the next token
+			text = row;
+			while ((c = pgm_read_byte(row)) >= ' ' && c < SCR_RUN) {
+				row++;
+				len++;
+			}
+		}
+		if (draw) {
+			if (len >= BLOCK_MIN) { USART_block(text, len, 1); }
+			else { for (c = 0; c < len; c++) { USART_put(pgm_read_byte(text + c)); } }
+			continue;
+		}
+		for (c = 0; c < len; c++) {
+			*sumA += pgm_read_byte(text + c);
+			*sumB += *sumA;
+		}
+	}
+	return c == NL ? row + 1 : row;
+}
+// offers the event stream in an APC string, a host front end answers EV_ACCEPT
+// terminals ignore the offer and never answer, so they get screens as before
+int eventDetect() {
+#if EVENTS
+	while (USART_tryGet() >= 0); // discard anything already received
+	USART_send_P(PSTR(EV_OFFER));
+	return USART_wait(EV_ACCEPT, TERM_DETECT_MS);
+#else
+	return 0;
+#endif
+}
+// sends what changed as the round entered state instead of drawing its screen: the state,
+// any hand that changed, results once the round is settled and the advice for a question
+// every hand is sent again at the start of each round, so a host that lost a packet catches up
+void eventShow(unsigned char state) {
+	unsigned char data[4] = { state, game.player, game.round & 0xFF, game.round >> 8 };
+	eventSend(EV_STATE, data, sizeof(data));
+	if (engineErr) {
+		eventSend(EV_ERROR, &engineErr, 1);
+		engineErr = 0;
+	}
+	if (state == ST_ROUND) { // cards are dealt once this state is left
+		memset(evSum, 0xFF, sizeof(evSum));
+		return;
+	}
+	eventHand(EV_DEALER, &dealer);
+	for (int ID = P1; ID <= NUMSEATS; ID++) {
+		for (int i = 0; i < SEATHANDS; i++) { eventHand(evHandId(ID, i), &seatOf(ID)->hands[i]); }
+	}
+	if (state == ST_RESULTS) {
+		for (int ID = P1; ID <= NUMSEATS; ID++) {
+			for (int i = 0; i < SEATHANDS; i++) {
+				hand *p = &seatOf(ID)->hands[i];
+				if (p->empty) { continue; }
+				data[0] = evHandId(ID, i);
+				data[1] = handResult(p);
+				eventSend(EV_RESULT, data, 2);
+			}
+		}
+	}
+	if (SHOW_ADVICE && gameNeedsInput()) {
+		data[0] = adviceFor(game.active, dealer.cards[1], state == ST_SPLIT);
+		eventSend(EV_ADVICE, data, 1);
+	}
+}
+// sends a hand as EV_HAND unless the host already has it as it is
+// change is spotted with a Fletcher-16 checksum, which catches any one card changing
+// its halves are taken mod 255, so a sum is never the 0xFFFF eventShow() uses to force a resend
+void eventHand(unsigned char id, hand *p) {
+	unsigned char data[3 + MAXHAND];
+	unsigned int sumA = p->handsize, sumB = sumA;
+	unsigned char flags = (p->soft ? EVH_SOFT : 0) | (p->busted ? EVH_BUSTED : 0);
+	for (unsigned char i = 0; i < p->handsize; i++) {
+		card c = p->cards[i];
+		if (c & CARD_DOWN) { // the host only learns a face down card once it is turned over
+			c = CARD_DOWN;
+			flags |= EVH_HIDDEN;
+		}
+		data[3 + i] = c;
+		sumA = (sumA + c) % 255;
+		sumB = (sumB + sumA) % 255;
+	}
+	uint16_t sum = (sumB << 8) | sumA;
+	if (evSum[id] == sum) { return; }
+	evSum[id] = sum;
+	data[0] = id;
+	data[1] = flags & EVH_HIDDEN ? 0 : p->handvalue;
+	data[2] = flags;
+	eventSend(EV_HAND, data, 3 + p->handsize);
+}
+// records noise mixed into the PRNG, with the decisions this is all a replay needs to deal the same cards
+void eventSeed(unsigned long noise) {
+	unsigned char data[4] = { noise, noise >> 8, noise >> 16, noise >> 24 };
+	eventSend(EV_SEED, data, sizeof(data));
+}
+// records the answer to a question and how long the seat took over it
+void eventInput(unsigned char state, int input, unsigned int ms) {
+	unsigned char data[4] = { state, input, ms & 0xFF, ms >> 8 };
+	eventSend(EV_INPUT, data, sizeof(data));
+}
+// sends one packet, the check byte makes everything after EV_SYNC add up to 0
+void eventSend(unsigned char type, const unsigned char *data, unsigned char len) {
+	unsigned char sum = type + len;
+	USART_put(EV_SYNC);
+	USART_put(type);
+	USART_put(len);
+	for (unsigned char i = 0; i < len; i++) {
+		USART_put(data[i]);
+		sum += data[i];
+	}
+	USART_put(-sum);
+}
+// moves terminal cursor to the first column of given row
+void termCursor(unsigned char row) {
+	termEsc(row + 1, 'H');
+}
+// sends ESC [ n cmd
+void termEsc(unsigned char n, char cmd) {
+	char num[4];
+	USART_put(ESC);
+	USART_put('[');
+	utoa(n, num, 10);
+	for (char *c = num; *c; c++) { USART_put(*c); }
+	USART_put(cmd);
+}
+// displays the upper part of the screen right before cards are displayed
+void dispUpper(int ID) {
+    char temp[6];
+    hand *pA, *pB;
+    if (engineErr == ERR_DEAL) { send_P(PSTR("ERROR: Cannot Deal Card!\n")); }
+    engineErr = 0;
+	if (ID == DEALER) {
+		send_P(PSTR("DEALER'S TURN.  "));
+        ID = NUMSEATS;
+	} else {
+		send_P(PSTR("PLAYER "));
+		sendChar(ID + ASCII_NUM);
+		send_P(PSTR("'S TURN."));
+    }
+    send_P(PSTR("				"));
+
+    for (int i = 1; i <= ID; i++) {
+        pA = &seatOf(i)->hands[0];
+        pB = &seatOf(i)->hands[1];
+        send_P(PSTR("Player "));
+		sendChar(i + ASCII_NUM);
+		send_P(PSTR("'s hand: ["));
+        itoa(pA->handvalue,temp,10);
+        send(temp);
+        
+        if (!pB->empty) {
+            send_P(PSTR("]["));
+            itoa(pB->handvalue,temp,10);
+            send(temp);
+        }
+        send_P(PSTR("]	"));
+    }
+    sendChar(NL);
+    sendChar(NL);
+    alignCenter(18);
+    send_P(PSTR("Dealer is showing:"));
+    sendChar(NL);
+
+    cardPrint(&dealer);
+}
+// displays introduction screen
+void dispIntro() {
+    frameBegin();
+    frameScreen_P(screenIntro, NULL);
+	frameEnd();
+	hold(DELAY_REFRESH);
+	
+	frameBegin();
+	frameScreen_P(screenCredits, NULL);
+	frameEnd();
+	hold(DELAY_REFRESH);
+}
+// displays blank screen
+void dispBlank() {
+    // blank screen
+	frameBegin();
+	frameEnd();
+	hold(DELAY_REFRESH);
+}
+// displays round screen
+void dispRound(int round) {
+    char str[5];
+    itoa(round,str,10);
+    frameBegin();
+    frameScreen_P(screenRound, str);
+    frameEnd();
+}
+// displays player turn screen
+void dispTurn(int ID) {
+    char num[2] = { ID + ASCII_NUM, '\0' };
+    frameBegin();
+    frameScreen_P(ID == DEALER ? screenDealerTurn : screenTurn, num);
+    frameEnd();
+}
+// displays results of the round
+void dispResults() {
+    frameBegin();
+    dispUpper(DEALER);
+    sendChar(NL);
+    if (game.settled && !SETTLED_DRAW) {
+        alignCenter(18);
+        send_P(msgDealerSkip);
+    } else if (dealer.busted) {
+        alignCenter(14);
+        send_P(PSTR("Dealer BUSTED!"));
+    } else {
+        alignCenter(20);
+        send_P(PSTR("Dealer stays with "));
+        char d[3];
+		itoa(dealer.handvalue,d,10);
+        send(d);
+    }
+    sendChar(NL);
+    sendChar(NL);
+    sendChar(NL);
+
+    hand *pA, *pB;
+    for (int ID = P1; ID <= NUMSEATS; ID++) {
+        pA = &seatOf(ID)->hands[0];
+        pB = &seatOf(ID)->hands[1];
+        send_P(PSTR("      Player "));
+        sendChar(ID + ASCII_NUM);
+        send_P(resultText(handResult(pA)));
+        char temp[3];
+		itoa(pA->handvalue,temp,10);
+		send(temp);
+        if (!pB->empty) {
+            send_P(PSTR(" and"));
+            send_P(resultText(handResult(pB)));
+		    itoa(pB->handvalue,temp,10);
+		    send(temp);
+        }
+        sendChar(NL);
+        sendChar(NL);
+    }
+    frameEnd();
+}
+// result of a hand as shown on the results screen
+PGM_P resultText(int result) {
+    switch (result) {
+        case WIN:  return PSTR(" WON with ");
+        case PUSH: return PSTR(" PUSHED with ");
+        default:   return PSTR(" LOST with ");
+    }
+}
+// displays the active hand under the dealer's cards, with a message line below it
+void dispHand(PGM_P msg) {
+    frameBegin();
+    dispUpper(game.player);
+    sendChar(NL);
+    alignCenter(23);
+    send_P(PSTR("Your current hand: ["));
+    char temp[3];
+    itoa(game.active->handvalue,temp,10);
+    send(temp);
+    send_P(PSTR("]"));
+    sendChar(NL);
+    cardPrint(game.active);
+    sendChar(NL);
+    sendChar(NL);
+    advice[0] = 0;
+    if (SHOW_ADVICE && gameNeedsInput()) { adviceText(advice); } // shares the message line, the screen has no row to spare
+    alignCenter(strlen_P(msg) + strlen(advice));
+    send_P(msg);
+    send(advice);
+    frameEnd();
+}
+// writes what basic strategy would do with the active hand and how often the dealer busts into adv
+void adviceText(char *adv) {
+    int split = (game.state == ST_SPLIT);
+    int move = adviceFor(game.active, dealer.cards[1], split);
+    uint8_t up = cardPoints(dealer.cards[1]);
+    strcpy_P(adv, PSTR("    Advice: "));
+    if (split) { strcat_P(adv, move == HIT ? PSTR("SPLIT") : PSTR("DON'T SPLIT")); }
+    else { strcat_P(adv, move == HIT ? PSTR("HIT") : PSTR("STAY")); }
+    strcat_P(adv, PSTR(", dealer busts "));
+    itoa(pgm_read_byte(&dealerOdds[up - 2][ODDS_BUST]) * 100 / 255, adv + strlen(adv), 10);
+    strcat_P(adv, PSTR("% of the time"));
+}
+// displays the dealer's cards, with a message line below them if given one
+void dispDealer(PGM_P msg) {
+    frameBegin();
+    dispUpper(DEALER);
+    if (msg) {
+        sendChar(NL);
+        sendChar(NL);
+        alignCenter(strlen_P(msg));
+        send_P(msg);
+    }
+    frameEnd();
+}
+// displays the dealer's cards and the value it stayed with
+void dispDealerStay(PGM_P msg) {
+    frameBegin();
+    dispUpper(DEALER);
+    sendChar(NL);
+    sendChar(NL);
+    alignCenter(20);
+    send_P(PSTR("Dealer stays with "));
+    char d[3];
+    itoa(dealer.handvalue,d,10);
+    send(d);
+    send_P(PSTR("!"));
+    frameEnd();
+}
+// game screen for the start of a round
+void drawRound(PGM_P msg) {
+    dispRound(game.round);
+}
+// game screen for the start of a player's turn
+void drawTurn(PGM_P msg) {
+    dispTurn(game.player);
+}
+// game screen once the round is settled
+void drawResults(PGM_P msg) {
+    dispResults();
+}
+// starts sampling the light sensor on ADC0 once per scheduler tick
+// conversions are auto triggered by Timer0's compare match, so nothing ever waits on them
+void ADC_init() {
+    DDRC = (0 << PINC0); // ADC0 input
+	ADMUX = (1 << REFS0) | (0 << MUX0); // input ADC0, right justified, AVcc
+	ADCSRB = (1 << ADTS1) | (1 << ADTS0); // trigger on Timer0 compare match A
+	// enable ADC with auto trigger and interrupt, set prescaler to 128
+	ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIE) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+}
+// light sensor noise gathered so far
+unsigned long ADC_pool() {
+	unsigned long pool;
+	cli();
+	pool = adcPool;
+	sei();
+	return pool;
+}
+// runs the round's state machine, one state per call
+// a state is left once its screen has been up for its hold time, or on HIT or STAY
+// a move only counts after the hand has left the sensor since the screen went up
+void taskGame() {
+	int input = ERROR;
+	if (!playing) { return; }
+	if (gameKeys() || game.state == ST_OVER) { return; }
+	unsigned char s = seatSensor(game.player);
+	if (moveSeq[s] != gameMoveSeq) { // new reading from the gesture classifier
+		gameMoveSeq = moveSeq[s];
+		if (lastMove[s] == NOACTION) { gameCleared = 1; }
+		else if (gameCleared) { input = lastMove[s]; }
+	}
+	if (game.state == ST_ACTION && input == ERROR && earlyMove[s] != ERROR) { // decided before the turn came round
+		input = earlyMove[s];
+		earlyMove[s] = ERROR;
+	}
+	if (gameNeedsInput()) {
+		if (input == ERROR && AUTOPLAY_MS && SCHED_now() - screenStart >= AUTOPLAY_MS) { // seat is empty, play it for them
+			input = adviceFor(game.active, dealer.cards[1], game.state == ST_SPLIT);
+		}
+		if (input == ERROR) { return; } // wait for the player
+		if (termEvents) { eventInput(game.state, input, SCHED_now() - screenStart); }
+	} else if (input == ERROR && SCHED_now() - screenStart < screenHold) {
+		return; // screen is still being held, a gesture skips it
+	}
+	PROF_START(t);
+	unsigned char state = gameStep(input);
+	PROF_STOP(PROF_ENGINE, t);
+	gameShow(state);
+}
+// checks the terminal for a request for the profile or stats screen, returns 1 if it drew one
+// only taskGame() calls it, so a key screen never lands in the middle of a game frame or the other way round
+// the game screen comes back after DELAY_READ, or sooner if the game moves on
+int gameKeys() {
+	if (termEvents) { return 0; } // a host front end owns the terminal
+	int key = USART_tryGet();
+#if PROFILE
+	if (key == KEY_PROFILE) {
+		dispProfile();
+		keyShown = SCHED_now() | 1; // never 0 while showing
+		return 1;
+	}
+#endif
+	if (key == KEY_STATS) {
+		dispStats();
+		keyShown = SCHED_now() | 1;
+		return 1;
+	}
+	if (keyShown && SCHED_now() - keyShown >= DELAY_READ) {
+		screen s;
+		memcpy_P(&s, &screens[game.state], sizeof(s));
+		if (s.draw) { s.draw(s.msg); }
+		keyShown = 0;
+		return 1;
+	}
+	return 0;
+}
+// basic strategy for the given hand against the dealer's up card, constant time lookup in strategy.h
+// for a split offer HIT means split
+int adviceFor(hand *p, card up, int splitOffer) {
+	uint16_t row;
+	if (splitOffer) {
+		row = pgm_read_word(&adviceSplit[cardPoints(p->cards[0]) - PAIR_MIN]);
+	} else if (p->soft) {
+		row = pgm_read_word(&adviceSoft[p->handvalue - SOFT_MIN]);
+	} else if (p->handvalue < HARD_MIN) {
+		return HIT;
+	} else {
+		row = pgm_read_word(&adviceHard[p->handvalue - HARD_MIN]);
+	}
+	return ((row >> (cardPoints(up) - 2)) & 1) ? HIT : STAY;
+}
+// draws the screen for the state the round just entered and starts its hold
+void gameShow(unsigned char state) {
+	screen s;
+	memcpy_P(&s, &screens[state], sizeof(s));
+	if (state == ST_ROUND) {
+		unsigned long noise = ADC_pool();
+		rngSeed(noise); // stir in light sensor noise gathered during the last round
+		if (termEvents) { eventSeed(noise); }
+		for (unsigned char i = 0; i < NUMSENSORS; i++) { earlyMove[i] = ERROR; } // moves made before the new cards were seen do not count
+	} else if (state == ST_RESULTS) {
+		statsRound();
+	}
+	PROF_START(t);
+	if (termEvents) { eventShow(state); }
+	else if (s.draw) { s.draw(s.msg); }
+	PROF_STOP(PROF_RENDER, t);
+	keyShown = 0;
+	screenStart = SCHED_now();
+	screenHold = s.hold;
+	if (game.settled && state >= ST_DEALER && state <= ST_DEALER_BUST) { screenHold = DELAY_FAST; } // fast-forward play that cannot change the results
+	unsigned char sensor = seatSensor(game.player);
+	gameMoveSeq = moveSeq[sensor];
+	gameCleared = 0;
+	if (gameNeedsInput()) { // only readings taken from now on count
+		USS_clear(sensor);
+		gestureReset(&ussGesture[sensor]);
+	}
+}
+// remembers errors reported by the game engine so the next screen can show them
+void engineError(unsigned char code) {
+	engineErr = code;
+}
+// initialize USART protocol for communication between atmega and atmel terminal
+void USART_init(unsigned int ubrr, unsigned char x2) {
+    //Set baud rate
+	UBRR0H = (unsigned char)(ubrr>>8);
+	UBRR0L = (unsigned char) ubrr;
+	UCSR0A = x2 ? (1 << U2X0) : 0;
+	// enable transmitter and receiver
+	UCSR0B = (1<<TXEN0)|(1<<RXEN0);
+	// Set frame format: async, no parity, 1 stop bit, , 8 data bits
+	UCSR0C = (0<<UMSEL01)|(0<<UMSEL00)|(0<<UPM01)|(0<<UPM00)|(0<<USBS0)|(1<<UCSZ01)|(1<<UCSZ00);
+	// transmit buffer is drained by USART_UDRE_vect
+	txHead = txTail = 0;
+	sei();
+}
+// transmit string to USART channel
+void send(const char* data) {
+    while (*data) {
+		sendChar(*data);
+		++data;
+	}
+}
+// transmit string stored in flash to USART channel
+void send_P(PGM_P data) {
+	char c;
+	while ((c = pgm_read_byte(data))) {
+		sendChar(c);
+		++data;
+	}
+}
+// adds single character to the line being drawn, NL sends the line to the terminal
+void sendChar(const char data) {
+	if (data == NL) { termLine(); }
+	else if (lineLen < TERMWIDTH) { line[lineLen++] = data; } // clip at right edge
+}
+// transmits single character to USART channel
+// blocks only while the transmit buffer is full
+void USART_put(const char data) {
+	if (USART_tryPut(data)) { return; }
+	PROF_START(t);
+	while (!USART_tryPut(data)) { SCHED_poll(); }
+	PROF_STOP(PROF_TXWAIT, t);
+}
+// transmits string stored in flash to USART channel
+void USART_send_P(PGM_P data) {
+	char c;
+	while ((c = pgm_read_byte(data))) {
+		USART_put(c);
+		++data;
+	}
+}
+// queues single character for transmission without waiting
+// returns 1 if the character was queued, 0 if the transmit buffer is full
+int USART_tryPut(const char data) {
+	unsigned char next = (txHead + 1) & (TX_BUFSIZE - 1);
+	if (next == txTail) { return 0; } // buffer full
+	txBuf[txHead] = data;
+	txHead = next;
+	txQueued++;
+	UCSR0B |= (1 << UDRIE0); // (re)start transmission from the buffer
+	return 1;
+}
+// queues len bytes to be sent straight from data, in flash if flash is true, after everything queued so far
+// nothing is copied, so data in SRAM must stay as it is until USART_flush() returns
+// waits only while every block slot is taken
+void USART_block(const char *data, unsigned char len, unsigned char flash) {
+	if (len == 0) { return; }
+	unsigned char next = (blkHead + 1) & (TX_BLOCKS - 1);
+	while (next == blkTail) { SCHED_poll(); }
+	volatile txBlock *b = &txBlocks[blkHead];
+	b->data = data;
+	b->len = len;
+	b->flash = flash;
+	b->at = txHead;
+	blkHead = next; // block is only seen by USART_UDRE_vect once it is complete
+	txQueued += len;
+	UCSR0B |= (1 << UDRIE0);
+}
+// waits until every queued character has been handed to the USART
+void USART_flush() {
+	while (txHead != txTail || blkHead != blkTail);
+}
+// waits up to ms for the given char, anything else received meanwhile is dropped
+int USART_wait(char c, unsigned int ms) {
+	unsigned int start = SCHED_now();
+	while (SCHED_now() - start < ms) {
+		if (USART_tryGet() == c) { return 1; }
+	}
+	return 0;
+}
+// offers BAUD_FAST in an APC string (ESC _ ... ESC \), which ordinary terminals ignore, see events.h
+// a host that can follow answers BAUD_ACCEPT, switches its port and then sends BAUD_CONFIRM at the new speed
+// without the BAUD_CONFIRM the link goes back to BAUD, returns true if the link is now at BAUD_FAST
+int USART_upgrade() {
+#if BAUD_FAST
+	char rate[8];
+	while (USART_tryGet() >= 0); // discard anything already received
+	USART_send_P(PSTR(BAUD_OFFER));
+	ultoa(BAUD_FAST, rate, 10);
+	for (char *c = rate; *c; c++) { USART_put(*c); }
+	USART_send_P(PSTR("\x1B\\"));
+	if (!USART_wait(BAUD_ACCEPT, TERM_DETECT_MS)) { return 0; }
+	USART_flush();
+	unsigned int start = SCHED_now();
+	while (SCHED_now() - start < 2 * (10000UL / BAUD) + 2); // last two bytes leave UDR0 and the shift register
+	USART_init(UBRR_FOR(BAUD_FAST, BAUD_FAST_2X), BAUD_FAST_2X);
+	if (USART_wait(BAUD_CONFIRM, TERM_DETECT_MS)) { return 1; }
+	USART_init(MYUBRR, BAUD_2X);
+#endif
+	return 0;
+}
+// returns next received character, or -1 if nothing has arrived
+int USART_tryGet() {
+	if (!(UCSR0A & (1 << RXC0))) { return -1; }
+	return UDR0;
+}
+// initialize ultrasonic sensor for touchless controls
+void USS_init() {
+    /*Ultrasonic Initialization
+	PB0 is the Echo Pin & PB1 is the Trigger, further sensors echo on PD4-PD6 & trigger on PB2-PB4*/
+	
+	//GPIO Programming
+	DDRB = USS_TRIGGERS;	//Output for Ultrasonic Trigger Pins
+	for (unsigned char s = 0; s < NUMSENSORS; s++) {
+		lastMove[s] = NOACTION;
+		earlyMove[s] = ERROR;
+	}
+
+	//Timer 1 Initialization
+	//free running, TIMER1_COMPB_vect triggers the sensors in turn, the echo is measured by TIMER1_CAPT_vect
+	TCCR1A = 0;				//Set all bit to zero Normal operation
+	TCCR1B = (1 << ICNC1) | (1 << ICES1) | (1 << CS11);	//noise canceler, rising edge, prescaler 8
+	OCR1B = 0;				//first slot at the next overflow
+	TIMSK1 = (1 << TOIE1) | (1 << OCIE1B) | (1 << ICIE1);	//Enable Timer1 overflow, trigger slot and input capture interrupts
+#if NUMSENSORS > 1
+	//echoes of the other sensors are timed by PCINT2_vect
+	for (unsigned char s = 1; s < NUMSENSORS; s++) { PCMSK2 |= (1 << USS_ECHO(s)); }
+	PCICR |= (1 << PCIE2);
+#endif
+	
+	//Enable Global Interrupts
+	sei();
+}
+// adds an echo width to sensor s's queue, dropping the oldest sample when it is full
+// only called from the capture interrupts
+void USS_push(unsigned char s, unsigned int ticks) {
+	unsigned char head = ussHead[s];
+	ussQueue[s][head] = ticks;
+	head = (head + 1) & (USS_QUEUE - 1);
+	if (head == ussTail[s]) { ussTail[s] = (head + 1) & (USS_QUEUE - 1); } // drop oldest
+	ussHead[s] = head;
+}
+// takes oldest echo sample measured by the capture interrupts for sensor s
+// returns 1 and stores the echo width in *ticks, or 0 if no new sample has arrived
+int USS_read(unsigned char s, unsigned int *ticks) {
+	int ready = 0;
+	cli();
+	if (ussHead[s] != ussTail[s]) {
+		*ticks = ussQueue[s][ussTail[s]];
+		ussTail[s] = (ussTail[s] + 1) & (USS_QUEUE - 1);
+		ready = 1;
+	}
+	sei();
+	return ready;
+}
+// discards samples sensor s measured before now
+void USS_clear(unsigned char s) {
+	cli();
+	ussTail[s] = ussHead[s];
+	sei();
+}
+// sensor the given seat plays with, seats share sensors in turn when there are fewer of them
+// the dealer's states and the intro use sensor 0
+unsigned char seatSensor(int ID) {
+	if (ID == DEALER) { return 0; }
+	return (ID - P1) % NUMSENSORS;
+}
+// determine which move zone a single distance reading falls in
+// distance is the echo width in timer ticks, compared against USS_TICKS(mm)
+int USS_zone(unsigned int ticks) {
+    if (ticks > USS_TICKS(DIST_HIT) && ticks < USS_TICKS(DIST_HIT + WIDTH)) {		//test for hit
+        return HIT;
+    } else if (ticks > USS_TICKS(DIST_STAY) && ticks < USS_TICKS(DIST_STAY + WIDTH)) {	//test for stay
+        return STAY;
+    }
+    return NOACTION;	//if not hit or stay, OR if nothings happening
+}
+// empties the gesture classifier's window
+void gestureReset(gesture *g) {
+    memset(g, 0, sizeof(*g));
+}
+// adds one sample's zone to the window of recent samples
+// returns that zone once GESTURE_CONFIDENCE samples in the window agree with it, otherwise ERROR
+int gestureFeed(gesture *g, int zone) {
+    if (g->filled == GESTURE_WINDOW) {
+        g->count[g->zone[g->next]]--; // oldest sample leaves the window
+    } else {
+        g->filled++;
+    }
+    g->zone[g->next] = zone;
+    g->count[zone]++;
+    g->next = (g->next + 1) % GESTURE_WINDOW;
+    if (g->count[zone] >= GESTURE_CONFIDENCE) {
+        return zone;
+    }
+    return ERROR;
+}
+// initialize Timer0 to interrupt every millisecond for the scheduler
+void SCHED_init() {
+	TCCR0A = (1 << WGM01);				// CTC mode
+	OCR0A = TICK_OCR;
+	TCCR0B = (1 << CS01) | (1 << CS00);	// prescaler 64
+	TIMSK0 = (1 << OCIE0A);				// Enable compare match interrupt
+	sei();
+}
+// returns milliseconds since power on
+unsigned int SCHED_now() {
+	cli(); // 16 bit read must not be split by the tick interrupt
+	unsigned int now = msTicks;
+	sei();
+	return now;
+}
+// runs every task whose deadline has passed
+// called from anywhere the game would otherwise sit waiting, so a task
+// blocked on a full transmit buffer still lets the other tasks run
+void SCHED_poll() {
+	unsigned int now = SCHED_now();
+	for (unsigned char i = 0; i < NUMTASKS; i++) {
+		if (!tasks[i].busy && (int) (now - tasks[i].due) >= 0) {
+			tasks[i].due = now + tasks[i].period;
+			tasks[i].busy = 1;
+			tasks[i].run();
+			tasks[i].busy = 0;
+		}
+	}
+}
+// keeps the current screen up for given milliseconds while other tasks keep running
+// a deliberate gesture (hand leaves the sensor, then HIT or STAY) skips the rest of the wait
+void hold(unsigned int ms) {
+	unsigned int start = SCHED_now();
+	unsigned char s = seatSensor(game.player);
+	unsigned char seq = moveSeq[s];
+	int cleared = 0;
+	while (SCHED_now() - start < ms) {
+		SCHED_poll();
+		if (moveSeq[s] != seq) {
+			seq = moveSeq[s];
+			if (lastMove[s] == NOACTION) { cleared = 1; }
+			else if (cleared) { return; }
+		}
+	}
+}
+// feeds every new ultrasonic sample to its sensor's gesture classifier
+// a sensor whose seat is not playing keeps the first move made once the hand has left it, see taskGame()
+void taskSensor() {
+	PROF_START(t);
+	unsigned int ticks;
+	unsigned char active = seatSensor(game.player);
+	for (unsigned char s = 0; s < NUMSENSORS; s++) {
+		while (USS_read(s, &ticks)) {
+			int move = gestureFeed(&ussGesture[s], USS_zone(ticks));
+			if (move == ERROR) { continue; }
+			lastMove[s] = move;
+			moveSeq[s]++;
+			if (s == active || !playing) { continue; }
+			if (move == NOACTION) { earlyCleared[s] = 1; }
+			else if (earlyCleared[s] && earlyMove[s] == ERROR) {
+				earlyMove[s] = move;
+				earlyCleared[s] = 0;
+			}
+		}
+	}
+	PROF_STOP(PROF_SENSOR, t);
+}
+// finds the newest valid record in the EEPROM log and carries on counting from it
+// erased EEPROM, a record cut short by losing power and a log for another seat count all fail the check
+void statsInit() {
+	int newest = -1;
+	uint16_t newestSeq = 0;
+	for (unsigned char slot = 0; slot < STATS_SLOTS; slot++) {
+		unsigned int addr = slot * sizeof(statsRecord);
+		unsigned char sum = 0;
+		for (unsigned char i = 0; i < sizeof(statsRecord); i++) { sum += eepromRead(addr + i); }
+		if (sum != 0 || eepromRead(addr) != STATS_MAGIC) { continue; }
+		addr += offsetof(statsRecord, seq);
+		uint16_t seq = eepromRead(addr) | (eepromRead(addr + 1) << 8);
+		if (newest < 0 || (int16_t) (seq - newestSeq) > 0) { // seq wraps, so newer is less than half the range ahead
+			newest = slot;
+			newestSeq = seq;
+		}
+	}
+	memset(&stats, 0, sizeof(stats));
+	stats.magic = STATS_MAGIC;
+	if (newest < 0) { return; } // no log yet, first record goes to slot 0
+	for (unsigned char i = 0; i < sizeof(statsRecord); i++) {
+		((unsigned char *) &stats)[i] = eepromRead(newest * sizeof(statsRecord) + i);
+	}
+	statsSlot = newest + 1 < STATS_SLOTS ? newest + 1 : 0;
+}
+// counts every hand of the round that just ended, then logs the new totals
+void statsRound() {
+	statsCount(&stats.rounds);
+	for (int ID = P1; ID <= NUMSEATS; ID++) {
+		seat *s = seatOf(ID);
+		seatStats *t = &stats.seats[ID - P1];
+		if (!s->hands[1].empty) { statsCount(&t->splits); }
+		for (int i = 0; i < SEATHANDS; i++) {
+			if (s->hands[i].empty) { continue; }
+			switch (handResult(&s->hands[i])) {
+				case WIN:  statsCount(&t->wins);   break;
+				case PUSH: statsCount(&t->pushes); break;
+				default:   statsCount(&t->losses); break;
+			}
+		}
+	}
+	statsWrite();
+}
+// adds one to a count, a count that has reached its limit stays there
+void statsCount(uint16_t *n) {
+	if (*n < 0xFFFF) { (*n)++; }
+}
+// seals a copy of the totals with the next seq and check and lets EE_READY_vect write it to the next slot
+// if a record is still going down, the next copy is taken as soon as it is done
+void statsWrite() {
+	unsigned char sreg = SREG;
+	cli();
+	if (EECR & (1 << EERIE)) {
+		statsPending = 1;
+	} else {
+		unsigned char sum = 0;
+		statsPending = 0;
+		stats.seq++;
+		statsOut = stats;
+		statsOut.check = 0;
+		for (unsigned char i = 0; i < sizeof(statsRecord); i++) { sum += ((unsigned char *) &statsOut)[i]; }
+		statsOut.check = -sum;
+		statsPos = 0;
+		EECR |= (1 << EERIE); // interrupt fires as soon as the EEPROM is ready
+	}
+	SREG = sreg;
+}
+// reads one byte of EEPROM, only used at reset before any write has been started
+unsigned char eepromRead(unsigned int addr) {
+	EEAR = addr;
+	EECR |= (1 << EERE);
+	return EEDR;
+}
+// displays the table stats kept in the EEPROM log
+void dispStats() {
+	char num[6];
+	frameBegin();
+	frameBlank(2);
+	send_P(PSTR("  TABLE STATS, "));
+	utoa(stats.rounds, num, 10);
+	send(num);
+	send_P(PSTR(" rounds, record "));
+	utoa(stats.seq, num, 10);
+	send(num);
+	send_P(PSTR(" of the EEPROM log\n\n"));
+	for (int ID = P1; ID <= NUMSEATS; ID++) {
+		seatStats *t = &stats.seats[ID - P1];
+		send_P(PSTR("  Player "));
+		sendChar(ID + ASCII_NUM);
+		send_P(PSTR(": "));
+		utoa(t->wins, num, 10);
+		send(num);
+		send_P(PSTR(" won, "));
+		utoa(t->losses, num, 10);
+		send(num);
+		send_P(PSTR(" lost, "));
+		utoa(t->pushes, num, 10);
+		send(num);
+		send_P(PSTR(" pushed, "));
+		utoa(t->splits, num, 10);
+		send(num);
+		send_P(PSTR(" splits\n"));
+	}
+	frameEnd();
+}
+// free running Timer1 ticks since reset, 1 tick = 8 cycles
+// Timer1 keeps counting through the ultrasonic sensor's cycle, overflows give the high word
+unsigned long profNow() {
+	unsigned char sreg = SREG;
+	cli();
+	unsigned int lo = TCNT1;
+	unsigned int hi = t1Overflows;
+	if ((TIFR1 & (1 << TOV1)) && lo < 0x8000) { hi++; } // overflowed but TIMER1_OVF_vect has not run yet
+	SREG = sreg;
+	return ((unsigned long) hi << 16) | lo;
+}
+// adds the time since start to a subsystem
+void profAdd(unsigned char id, unsigned long start) {
+	profTicks[id] += profNow() - start;
+	profCalls[id]++;
+}
+#if PROFILE
+extern unsigned char _end; // first byte past .data and .bss
+extern unsigned char __stack; // top of SRAM, where the stack starts
+// paints every byte between the end of .bss and the top of SRAM before main() runs
+// written in assembly since there is no stack or zero register yet in .init1
+void stackPaint() __attribute__ ((naked, used, section (".init1")));
+void stackPaint() {
+	__asm volatile (
+		"	ldi r30, lo8(_end)\n"
+		"	ldi r31, hi8(_end)\n"
+		"	ldi r24, %0\n"
+		"	ldi r25, hi8(__stack)\n"
+		"	rjmp 2f\n"
+		"1:	st Z+, r24\n"
+		"2:	cpi r30, lo8(__stack)\n"
+		"	cpc r31, r25\n"
+		"	brlo 1b\n"
+		"	breq 1b\n"
+		:: "M" (STACK_PAINT));
+}
+// bytes above .bss that still hold the paint
+unsigned int stackUnused() {
+	unsigned char *p = &_end;
+	while (p <= &__stack && *p == STACK_PAINT) { p++; }
+	return p - &_end;
+}
+#else
+unsigned int stackUnused() {
+	return 0;
+}
+#endif
+// displays the profile screen, times are in us since one Timer1 tick is 1 us at 8 MHz
+void dispProfile() {
+	static const char names[PROF_N][8] PROGMEM = { "render", "engine", "sensor", "tx wait" };
+	char num[11];
+	frameBegin();
+	frameBlank(2);
+	send_P(PSTR("  PROFILE (us, nested time counts in both)\n\n"));
+	for (unsigned char i = 0; i < PROF_N; i++) {
+		send_P(PSTR("  "));
+		send_P(names[i]);
+		send_P(PSTR(": "));
+		ultoa(profCalls[i], num, 10);
+		send(num);
+		send_P(PSTR(" runs, "));
+		ultoa(profTicks[i], num, 10);
+		send(num);
+		send_P(PSTR(" total, "));
+		ultoa(profCalls[i] ? profTicks[i] / profCalls[i] : 0, num, 10);
+		send(num);
+		send_P(PSTR(" each\n"));
+	}
+	send_P(PSTR("\n  last frame "));
+	utoa(frameBytes, num, 10);
+	send(num);
+	send_P(PSTR(" bytes, largest "));
+	utoa(frameMax, num, 10);
+	send(num);
+	send_P(PSTR(" bytes, "));
+	ultoa(txQueued, num, 10);
+	send(num);
+	send_P(PSTR(" since reset\n"));
+	send_P(PSTR("  stack never reached "));
+	utoa(stackUnused(), num, 10);
+	send(num);
+	send_P(PSTR(" bytes of SRAM\n"));
+	frameEnd();
+}
@@ -0,0 +1,234 @@
+// TAPjack benchmarks
+// times the renderer, the rules engine and the shuffler so every performance change comes with a number
+// builds natively against port/, where the USART is a sink, or for the ATmega328P to run under simavr
+// host times are in ns, target times are in CPU cycles from Timer1, see profNow()
+
+#ifdef __AVR__
+#include <avr/sleep.h>
+#else
+#include <time.h>
+#endif
+#include <stdio.h>
+#include <math.h>
+
+// the firmware has no header, so it is built as part of the benchmark with its main() out of the way
+#define main tapjackMain
+#include "TAPjack.c"
+#undef main
+
+#ifdef __AVR__
+#ifndef BENCH_FRAMES
+#define BENCH_FRAMES 5 // frames drawn per screen and terminal mode, every byte goes out at BAUD under simavr
+#endif
+#ifndef BENCH_ROUNDS
+#define BENCH_ROUNDS 200 // rounds played through the engine
+#endif
+#ifndef BENCH_SHUFFLES
+#define BENCH_SHUFFLES 520 // shoes shuffled and dealt out
+#endif
+#ifndef BENCH_DEPTH
+#define BENCH_DEPTH 1 // cards after each shuffle checked for bias, 104 bytes of SRAM each
+#endif
+#define TIME_UNIT "cycles"
+#else
+#ifndef BENCH_FRAMES
+#define BENCH_FRAMES 20000
+#endif
+#ifndef BENCH_ROUNDS
+#define BENCH_ROUNDS 1000000
+#endif
+#ifndef BENCH_SHUFFLES
+#define BENCH_SHUFFLES 100000
+#endif
+#ifndef BENCH_DEPTH
+#define BENCH_DEPTH 8
+#endif
+#define TIME_UNIT "ns"
+#endif
+#define BIAS_LIMIT 4 // standard deviations the chi-square may stray before the shuffle counts as biased
+
+// a screen to benchmark, drawn as one frame
+typedef struct benchScreen {
+	const char *name;
+	void (*draw)();
+	} benchScreen;
+
+// screens
+void drawUpper(); // dispUpper() for the dealer, every player's totals and the dealer's cards
+void drawCards(); // cardPrint() of the dealer's hand on its own
+void drawTable(); // dispHand() for the first player
+void drawEnd(); // dispResults()
+
+benchScreen benchScreens[] = {
+	{ "upper", drawUpper },
+	{ "cards", drawCards },
+	{ "hand", drawTable },
+	{ "results", drawEnd },
+};
+#define NUMSCREENS (sizeof(benchScreens) / sizeof(benchScreens[0]))
+
+// benchmarks
+void benchRender(); // bytes and time per frame for every screen in every terminal mode
+void benchEngine(); // hands per second through the rules engine
+int benchShuffle(); // shuffles per second, returns true if the deal looks biased
+void benchTable(); // play one round so the screens have hands to show
+unsigned long benchElapsed(unsigned long start); // time since start, less time spent waiting on the USART
+unsigned long benchNow(); // current time
+void benchPrint(const char *text); // write one line of results
+
+int main() {
+#ifdef __AVR__
+	USART_init(MYUBRR, BAUD_2X);
+	SCHED_init();
+	USS_init(); // starts Timer1, which profNow() counts
+#endif
+	benchPrint("TAPjack benchmark, times in " TIME_UNIT "\n");
+	benchRender();
+	benchEngine();
+	int biased = benchShuffle();
+#ifdef __AVR__
+	char text[40];
+	snprintf(text, sizeof(text), "stack never reached %u bytes\n", stackUnused());
+	benchPrint(text);
+	USART_flush();
+	cli();
+	sleep_enable();
+	sleep_cpu(); // simavr stops here
+#endif
+	return biased;
+}
+// draws every screen cold (terminal blank), warm (same frame already showing) and on a dumb terminal
+void benchRender() {
+	char text[80];
+	benchTable();
+	for (unsigned char i = 0; i < NUMSCREENS; i++) {
+		for (unsigned char mode = 0; mode < 3; mode++) {
+			termAnsi = mode < 2;
+			memset(rowSum, 0, sizeof(rowSum));
+			if (mode == 1) { benchScreens[i].draw(); } // put the frame up once so every rep matches it
+			unsigned long bytes = txQueued;
+			unsigned long start = benchNow();
+			for (unsigned int n = 0; n < BENCH_FRAMES; n++) {
+				if (mode == 0) { memset(rowSum, 0, sizeof(rowSum)); }
+				benchScreens[i].draw();
+			}
+			unsigned long time = benchElapsed(start);
+			snprintf(text, sizeof(text), "frame %-8s %-5s %6lu bytes %10lu " TIME_UNIT "\n", benchScreens[i].name,
+				mode == 0 ? "cold" : mode == 1 ? "warm" : "dumb", (txQueued - bytes) / BENCH_FRAMES, time / BENCH_FRAMES);
+			benchPrint(text);
+		}
+	}
+}
+// plays rounds with basic strategy from the advice tables, splits included
+void benchEngine() {
+	char text[80];
+	unsigned long hands = 0, rounds = 0;
+	rngSeed(1);
+	initDeck();
+	gameStart();
+	unsigned long start = benchNow();
+	while (rounds < BENCH_ROUNDS) {
+		int input = ERROR;
+		if (gameNeedsInput()) { input = adviceFor(game.active, dealer.cards[1], game.state == ST_SPLIT); }
+		switch (gameStep(input)) {
+			case ST_RESULTS:
+			for (seat *s = seats; s < seats + NUMSEATS; s++) { hands += 1 + !s->hands[1].empty; }
+			rounds++;
+			break;
+			case ST_OVER:
+			gameStart();
+			break;
+		}
+	}
+	unsigned long time = benchElapsed(start);
+	snprintf(text, sizeof(text), "engine %lu rounds %lu hands %10lu " TIME_UNIT " per hand\n", rounds, hands, time / hands);
+	benchPrint(text);
+}
+// shuffles and deals out whole shoes, and checks the first cards after every shuffle with a chi-square test
+// every card value should turn up equally often in every position
+int benchShuffle() {
+	static unsigned int seen[BENCH_DEPTH][SINGLEDECK];
+	char text[80];
+	hand h;
+	rngSeed(2);
+	initDeck();
+	memset(seen, 0, sizeof(seen));
+	emptyHand(&h);
+	unsigned long start = benchNow();
+	for (unsigned long s = 0; s < BENCH_SHUFFLES; s++) {
+		shuffleDeck();
+		for (unsigned int i = 0; i < SHOESIZE; i++) {
+			if (h.handsize == MAXHAND) { emptyHand(&h); }
+			dealCard(&h);
+			if (i < BENCH_DEPTH) { seen[i][h.cards[h.handsize - 1] & CARD_INDEX]++; }
+		}
+	}
+	unsigned long time = benchElapsed(start);
+
+	double expect = (double) BENCH_SHUFFLES / SINGLEDECK, chi = 0;
+	for (unsigned int i = 0; i < BENCH_DEPTH; i++) {
+		for (unsigned int c = 0; c < SINGLEDECK; c++) { chi += (seen[i][c] - expect) * (seen[i][c] - expect) / expect; }
+	}
+	unsigned int dof = BENCH_DEPTH * (SINGLEDECK - 1);
+	double z = (chi - dof) / sqrt(2.0 * dof); // chi-square is close to normal at this many degrees of freedom
+	int biased = z > BIAS_LIMIT || z < -BIAS_LIMIT;
+	snprintf(text, sizeof(text), "shuffle %lu shoes %10lu " TIME_UNIT " per shoe of %u cards\n", (unsigned long) BENCH_SHUFFLES, time / BENCH_SHUFFLES, SHOESIZE);
+	benchPrint(text);
+	snprintf(text, sizeof(text), "bias chi-square %ld.%02ld on %u degrees of freedom, z %ld.%02ld, %s\n",
+		(long) chi, (long) (chi * 100) % 100, dof, (long) z, labs((long) (z * 100) % 100), biased ? "BIASED" : "ok");
+	benchPrint(text);
+	return biased;
+}
+// deals a round and plays it out with every seat hitting once, so the screens show full hands
+void benchTable() {
+	rngSeed(3);
+	initDeck();
+	gameStart();
+	while (game.state != ST_RESULTS) {
+		gameStep(gameNeedsInput() ? (game.active->handsize < 3 ? HIT : STAY) : ERROR);
+	}
+}
+void drawUpper() {
+	frameBegin();
+	dispUpper(DEALER);
+	frameEnd();
+}
+void drawCards() {
+	frameBegin();
+	cardPrint(&dealer);
+	frameEnd();
+}
+void drawTable() {
+	game.active = &seats[0].hands[0];
+	game.player = P1;
+	dispHand(msgAction);
+}
+void drawEnd() {
+	dispResults();
+}
+#ifdef __AVR__
+// Timer1 ticks are 8 cycles, time the USART kept the benchmark waiting is left out
+unsigned long benchNow() {
+	return profNow() - profTicks[PROF_TXWAIT];
+}
+unsigned long benchElapsed(unsigned long start) {
+	return (benchNow() - start) * 8;
+}
+// sends the line as it is, not through the frame renderer
+void benchPrint(const char *text) {
+	while (*text) { USART_put(*text++); }
+}
+#else
+// the sink never keeps the host waiting
+unsigned long benchNow() {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1000000000UL + t.tv_nsec;
+}
+unsigned long benchElapsed(unsigned long start) {
+	return benchNow() - start;
+}
+void benchPrint(const char *text) {
+	fputs(text, stdout);
+}
+#endif
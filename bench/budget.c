@@ -0,0 +1,283 @@
+// TAPjack SRAM budget
+// reads the call graphs gcc writes with -fcallgraph-info=su and finds the deepest stack main() can reach,
+// adds the deepest interrupt on top and the static data beside it, and fails if that does not fit in SRAM
+// sizes come from the compiler, so the report is only as good as the graph: calls through pointers
+// are resolved with -i patterns, a scheduler that runs again from inside a task can be limited to the tasks
+// that can really start then with -n, and any other recursive call is cut and reported, cover its depth with -m
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAXFUNCS 1024
+#define MAXCALLS 8192
+#define MAXNAME 64
+#define MAXPATTERNS 32
+#define INDIRECT "__indirect_call" // gcc's node for a call through a pointer
+#define NESTED " (nested)" // added to a function's name for its -n copy
+
+typedef struct func {
+	char name[MAXNAME];
+	long frame; // bytes of stack the function itself uses, -1 = no figure
+	int dynamic; // frame grows at run time, e.g. a variable length array
+	int first; // this function's calls in calls[], first and count
+	int count;
+	int state; // 0 = not searched, 1 = being searched, 2 = done
+	long worst; // deepest stack from this function down, once done
+	int next; // callee on that deepest path, -1 = none
+	} func;
+
+typedef struct edge {
+	int from, to;
+	} edge;
+
+func funcs[MAXFUNCS];
+int numFuncs = 0;
+edge edges[MAXCALLS]; // calls as read, sorted into calls[] once every file is in
+int numEdges = 0;
+int calls[MAXCALLS];
+// functions a call through a pointer may reach, as caller:callee or just callee for any caller
+const char *patterns[MAXPATTERNS];
+int numPatterns = 0;
+// functions that run nested when called from anywhere but main, as func:callee for what they can reach then
+const char *nested[MAXPATTERNS];
+int numNested = 0;
+int callBytes = 0; // return address pushed by every call
+
+// graph
+int funcFind(const char *name); // index of a function, added if it is new
+void graphRead(const char *file); // add one .ci file
+void graphLink(); // sort the calls by caller
+int graphNest(const char *rule, int n); // split off a function's nested copy, returns the new end of calls[]
+int callAdd(int f, int n, int callee); // add one call to f's list
+int matches(const char *caller, const char *callee); // true if a call through a pointer may go from caller to callee
+int matchOne(const char *pattern, const char *caller, const char *callee); // true if one caller:callee pattern allows the call
+long deepest(int f); // deepest stack from f down
+void printPath(const char *title, int f); // print the deepest path from f
+void usage(const char *prog);
+
+int main(int argc, char **argv) {
+	long sram = 2048, data = 0, margin = 0;
+	int opt;
+	while ((opt = getopt(argc, argv, "s:d:m:c:i:n:h")) != -1) {
+		switch (opt) {
+			case 's':
+			sram = strtol(optarg, NULL, 0);
+			break;
+			case 'd':
+			data = strtol(optarg, NULL, 0);
+			break;
+			case 'm':
+			margin = strtol(optarg, NULL, 0);
+			break;
+			case 'c':
+			callBytes = atoi(optarg);
+			break;
+			case 'i':
+			if (numPatterns < MAXPATTERNS) { patterns[numPatterns++] = optarg; }
+			break;
+			case 'n':
+			if (!strchr(optarg, ':')) {
+				usage(argv[0]);
+				return 1;
+			}
+			if (numNested < MAXPATTERNS) { nested[numNested++] = optarg; }
+			break;
+			default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+	if (optind == argc) {
+		usage(argv[0]);
+		return 1;
+	}
+	for (int i = optind; i < argc; i++) { graphRead(argv[i]); }
+	graphLink();
+
+	int root = funcFind("main");
+	long stack = deepest(root);
+	printPath("main", root);
+
+	// interrupts do not nest, so only the deepest one lands on top of main's stack
+	long isr = 0;
+	int worstIsr = -1;
+	for (int f = 0; f < numFuncs; f++) {
+		size_t n = strlen(funcs[f].name);
+		if (n > 5 && strcmp(funcs[f].name + n - 5, "_vect") == 0 && deepest(f) > isr) {
+			isr = deepest(f);
+			worstIsr = f;
+		}
+	}
+	if (worstIsr >= 0) {
+		isr += callBytes; // the CPU pushes the return address like a call
+		printPath("interrupt", worstIsr);
+	}
+
+	long total = stack + isr + data + margin;
+	printf("static data %ld bytes, margin %ld bytes\n", data, margin);
+	printf("total %ld of %ld bytes SRAM, %ld spare\n", total, sram, sram - total);
+	if (total > sram) {
+		printf("over budget\n");
+		return 1;
+	}
+	return 0;
+}
+// finds a function by name, adds it without a frame if it is new
+int funcFind(const char *name) {
+	for (int f = 0; f < numFuncs; f++) {
+		if (strcmp(funcs[f].name, name) == 0) { return f; }
+	}
+	if (numFuncs == MAXFUNCS) {
+		fprintf(stderr, "more than %d functions\n", MAXFUNCS);
+		exit(1);
+	}
+	func *p = &funcs[numFuncs];
+	snprintf(p->name, MAXNAME, "%s", name);
+	p->frame = -1;
+	p->next = -1;
+	return numFuncs++;
+}
+// adds the nodes and edges of one .ci file
+// node: { title: "name" label: "name\nfile:line:col\nN bytes (static)" }
+// edge: { sourcename: "caller" targetname: "callee" label: "file:line:col" }
+void graphRead(const char *file) {
+	FILE *in = fopen(file, "r");
+	if (!in) {
+		perror(file);
+		exit(1);
+	}
+	char line[512], a[MAXNAME], b[MAXNAME];
+	while (fgets(line, sizeof(line), in)) {
+		if (sscanf(line, "node: { title: \"%63[^\"]\"", a) == 1) {
+			int f = funcFind(a);
+			char *size = strstr(line, " bytes (");
+			if (size) {
+				while (size > line && size[-1] >= '0' && size[-1] <= '9') { size--; }
+				funcs[f].frame = atol(size);
+				funcs[f].dynamic = strstr(line, "(dynamic") != NULL;
+			}
+		} else if (sscanf(line, "edge: { sourcename: \"%63[^\"]\" targetname: \"%63[^\"]\"", a, b) == 2) {
+			if (numEdges == MAXCALLS) {
+				fprintf(stderr, "more than %d calls\n", MAXCALLS);
+				exit(1);
+			}
+			edges[numEdges].from = funcFind(a);
+			edges[numEdges].to = funcFind(b);
+			numEdges++;
+		}
+	}
+	fclose(in);
+}
+// lays the calls out by caller, a call through a pointer becomes a call to every function -i allows
+void graphLink() {
+	int indirect = funcFind(INDIRECT);
+	int n = 0;
+	for (int f = 0; f < numFuncs; f++) {
+		funcs[f].first = n;
+		for (int e = 0; e < numEdges; e++) {
+			if (edges[e].from != f) { continue; }
+			if (edges[e].to != indirect) {
+				n = callAdd(f, n, edges[e].to);
+				continue;
+			}
+			if (numPatterns == 0) { fprintf(stderr, "warning: %s calls through a pointer, give -i for its targets\n", funcs[f].name); }
+			for (int t = 0; t < numFuncs; t++) {
+				if (t != indirect && funcs[t].frame >= 0 && matches(funcs[f].name, funcs[t].name)) { n = callAdd(f, n, t); }
+			}
+		}
+		funcs[f].count = n - funcs[f].first;
+	}
+	for (int i = 0; i < numNested; i++) { n = graphNest(nested[i], n); }
+}
+// for func:callee, calls into func from anywhere but main go to a copy of it that only calls what callee matches
+// e.g. a scheduler polled from inside a blocked task cannot start that task again, so its copy leaves it out
+int graphNest(const char *rule, int n) {
+	char name[MAXNAME];
+	const char *colon = strchr(rule, ':');
+	snprintf(name, MAXNAME, "%.*s", (int) (colon - rule), rule);
+	int f = funcFind(name), root = funcFind("main");
+	snprintf(name, MAXNAME, "%s" NESTED, funcs[f].name);
+	int copy = funcFind(name);
+	funcs[copy].frame = funcs[f].frame;
+	funcs[copy].dynamic = funcs[f].dynamic;
+	funcs[copy].first = n;
+	for (int i = funcs[f].first; i < funcs[f].first + funcs[f].count; i++) {
+		if (matchOne(rule, funcs[f].name, funcs[calls[i]].name)) { n = callAdd(copy, n, calls[i]); }
+	}
+	funcs[copy].count = n - funcs[copy].first;
+	for (int g = 0; g < numFuncs; g++) {
+		if (g == root || g == copy) { continue; }
+		for (int i = funcs[g].first; i < funcs[g].first + funcs[g].count; i++) {
+			if (calls[i] == f) { calls[i] = copy; }
+		}
+	}
+	return n;
+}
+// adds a call from f to callee at calls[n] unless f already has it, returns the new n
+int callAdd(int f, int n, int callee) {
+	for (int i = funcs[f].first; i < n; i++) {
+		if (calls[i] == callee) { return n; }
+	}
+	if (n == MAXCALLS) {
+		fprintf(stderr, "more than %d calls\n", MAXCALLS);
+		exit(1);
+	}
+	calls[n] = callee;
+	return n + 1;
+}
+// true if one of the -i patterns lets caller reach callee through a pointer, a trailing * matches any ending
+int matches(const char *caller, const char *callee) {
+	for (int i = 0; i < numPatterns; i++) {
+		if (matchOne(patterns[i], caller, callee)) { return 1; }
+	}
+	return 0;
+}
+// true if one [caller:]callee pattern allows caller to reach callee
+int matchOne(const char *pattern, const char *caller, const char *callee) {
+	const char *p = pattern, *colon = strchr(p, ':');
+	if (colon) {
+		if (strlen(caller) != (size_t) (colon - p) || strncmp(caller, p, colon - p) != 0) { return 0; }
+		p = colon + 1;
+	}
+	size_t n = strlen(p);
+	return n && p[n - 1] == '*' ? strncmp(callee, p, n - 1) == 0 : strcmp(callee, p) == 0;
+}
+// deepest stack from f down, each function is searched once and remembered
+// a call back into a function still being searched is recursion, it is cut and reported
+long deepest(int f) {
+	func *p = &funcs[f];
+	if (p->state == 2) { return p->worst; }
+	p->state = 1;
+	long below = 0;
+	for (int i = 0; i < p->count; i++) {
+		int c = calls[p->first + i];
+		if (funcs[c].state == 1) {
+			fprintf(stderr, "warning: %s calls back into %s, recursion is counted once\n", p->name, funcs[c].name);
+			continue;
+		}
+		long s = deepest(c) + callBytes;
+		if (s > below) {
+			below = s;
+			p->next = c;
+		}
+	}
+	p->worst = (p->frame > 0 ? p->frame : 0) + below;
+	p->state = 2;
+	return p->worst;
+}
+// prints the deepest path from f, one function and its own frame per line
+void printPath(const char *title, int f) {
+	printf("%s: %ld bytes of stack\n", title, deepest(f));
+	for (int depth = 0; f >= 0 && depth < MAXFUNCS; f = funcs[f].next, depth++) {
+		func *p = &funcs[f];
+		if (p->frame < 0) { printf("  %-24s no figure, counted as 0\n", p->name); }
+		else { printf("  %-24s %4ld%s\n", p->name, p->frame, p->dynamic ? " + dynamic" : ""); }
+	}
+}
+void usage(const char *prog) {
+	fprintf(stderr, "usage: %s [-s sram] [-d static data] [-m margin] [-c bytes per call] [-i pattern]... [-n pattern]... file.ci...\n"
+		"  -i [caller:]callee, what a call through a pointer may reach, callee may end in * to match a prefix\n"
+		"  -n func:callee, func runs nested when called from anywhere but main and can only reach callee then\n", prog);
+}
@@ -0,0 +1,11 @@
+// host stand-in for avr/interrupt.h
+// nothing interrupts the host, so enabling interrupts runs whatever would have been waiting, see port.c
+#ifndef PORT_AVR_INTERRUPT_H
+#define PORT_AVR_INTERRUPT_H
+
+#define ISR(vector) void vector(void); void vector(void)
+void portInterrupts();
+#define sei() portInterrupts()
+#define cli()
+
+#endif
@@ -0,0 +1,80 @@
+// host stand-in for avr/io.h, just enough of the ATmega328P for the firmware to build natively
+// registers are plain variables in port.c, nothing behind them moves on its own
+#ifndef PORT_AVR_IO_H
+#define PORT_AVR_IO_H
+
+#include <stdint.h>
+
+#define REG8(n) extern volatile uint8_t n;
+#define REG16(n) extern volatile uint16_t n;
+REG8(UBRR0H) REG8(UBRR0L) REG8(UCSR0A) REG8(UCSR0B) REG8(UCSR0C) REG8(UDR0)
+REG16(UBRR0)
+REG8(DDRB) REG8(PORTB) REG8(PINB) REG8(DDRC) REG8(PORTC) REG8(PINC) REG8(DDRD) REG8(PORTD) REG8(PIND)
+REG8(TIMSK0) REG8(TCCR0A) REG8(TCCR0B) REG8(OCR0A) REG8(TCNT0) REG8(TIFR0)
+REG8(TIMSK1) REG8(TCCR1A) REG8(TCCR1B) REG8(TIFR1)
+REG16(TCNT1) REG16(ICR1) REG16(OCR1A) REG16(OCR1B)
+REG8(PCICR) REG8(PCMSK2)
+REG8(ADMUX) REG8(ADCSRA) REG8(ADCSRB) REG8(DIDR0)
+REG16(ADC)
+REG8(EECR) REG8(EEDR)
+REG16(EEAR)
+REG8(SREG)
+
+#define E2END 0x3FF // last EEPROM address
+
+// bits
+#define RXC0 7
+#define UDRE0 5
+#define U2X0 1
+#define RXEN0 4
+#define TXEN0 3
+#define UDRIE0 5
+#define UMSEL01 7
+#define UMSEL00 6
+#define UPM01 5
+#define UPM00 4
+#define USBS0 3
+#define UCSZ01 2
+#define UCSZ00 1
+#define PB0 0
+#define PB1 1
+#define PD3 3
+#define PCIE2 2
+#define PINC0 0
+#define OCIE0A 1
+#define WGM01 1
+#define CS00 0
+#define CS01 1
+#define CS11 1
+#define TOIE1 0
+#define OCIE1A 1
+#define OCIE1B 2
+#define ICIE1 5
+#define ICNC1 7
+#define ICES1 6
+#define TOV1 0
+#define OCF1A 1
+#define ICF1 5
+#define REFS0 6
+#define ADEN 7
+#define ADSC 6
+#define ADATE 5
+#define ADIE 3
+#define ADPS2 2
+#define ADPS1 1
+#define ADPS0 0
+#define ADTS0 0
+#define ADTS1 1
+#define MUX0 0
+#define ADC0D 0
+#define EERIE 3
+#define EEMPE 2
+#define EEPE 1
+#define EERE 0
+
+// avr-libc's stdlib.h has these
+char *itoa(int value, char *s, int radix);
+char *utoa(unsigned int value, char *s, int radix);
+char *ultoa(unsigned long value, char *s, int radix);
+
+#endif
@@ -0,0 +1,18 @@
+// host stand-in for avr/pgmspace.h, flash and SRAM are the same memory on the host
+#ifndef PORT_AVR_PGMSPACE_H
+#define PORT_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strcat_P strcat
+
+#endif
@@ -0,0 +1,41 @@
+// host side of the ATmega328P stand-in headers
+// the USART sink throws every byte away, the firmware's own txQueued counts what was sent
+
+#include <stdio.h>
+#include "avr/io.h"
+
+volatile uint8_t UBRR0H, UBRR0L, UCSR0A, UCSR0B, UCSR0C, UDR0;
+volatile uint16_t UBRR0;
+volatile uint8_t DDRB, PORTB, PINB, DDRC, PORTC, PINC, DDRD, PORTD, PIND;
+volatile uint8_t TIMSK0, TCCR0A, TCCR0B, OCR0A, TCNT0, TIFR0;
+volatile uint8_t TIMSK1, TCCR1A, TCCR1B, TIFR1;
+volatile uint16_t TCNT1, ICR1, OCR1A, OCR1B;
+volatile uint8_t PCICR, PCMSK2;
+volatile uint8_t ADMUX, ADCSRA, ADCSRB, DIDR0;
+volatile uint16_t ADC;
+volatile uint8_t EECR, EEDR;
+volatile uint16_t EEAR;
+volatile uint8_t SREG;
+
+// the firmware's interrupt handlers
+void USART_UDRE_vect(void);
+void TIMER0_COMPA_vect(void);
+
+// runs the interrupts that would have been waiting when the firmware enables them again
+// the transmit path empties into the sink and the 1 ms tick moves on, so every wait in the firmware ends
+void portInterrupts() {
+	while (UCSR0B & (1 << UDRIE0)) { USART_UDRE_vect(); }
+	TIMER0_COMPA_vect();
+}
+char *itoa(int value, char *s, int radix) {
+	sprintf(s, radix == 16 ? "%x" : "%d", value);
+	return s;
+}
+char *utoa(unsigned int value, char *s, int radix) {
+	sprintf(s, radix == 16 ? "%x" : "%u", value);
+	return s;
+}
+char *ultoa(unsigned long value, char *s, int radix) {
+	sprintf(s, radix == 16 ? "%lx" : "%lu", value);
+	return s;
+}
@@ -0,0 +1,175 @@
+// TAPjack session replay
+// plays a saved event stream back through the firmware's own engine and renderer with every hold
+// left out, so a session from the table can be reproduced and timed on the host as often as needed
+// the stream is what view/tapview -r saves from the board: the seeds and decisions drive the replay,
+// the states and errors it recorded are checked against what the replay does
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+// the firmware has no header, so it is built as part of the replay with its main() out of the way
+// and its engineError() renamed, the replay's own counts every error before passing it on
+#define main tapjackMain
+#define engineError tapjackEngineError
+#include "TAPjack.c"
+#undef main
+#undef engineError
+
+#define MAXRECORDS 65536
+
+// one packet of the stream, payload as sent
+typedef struct record {
+	unsigned char type;
+	unsigned char len;
+	unsigned char data[EV_MAXLEN];
+	} record;
+
+record records[MAXRECORDS];
+int numRecords = 0;
+unsigned long errors = 0; // engineError() calls made by the replay
+
+void engineError(unsigned char code); // count an error, then report it like the firmware does
+int readStream(const char *file); // load every packet that passes its check
+int nextRecord(int from, unsigned char type); // index of the next packet of a type, -1 = none
+unsigned long replayNow(); // ns from a monotonic clock
+void usage(const char *prog);
+
+int main(int argc, char **argv) {
+	int opt, quiet = 0;
+	termAnsi = 1;
+	while ((opt = getopt(argc, argv, "dqh")) != -1) {
+		switch (opt) {
+			case 'd':
+			termAnsi = 0;
+			break;
+			case 'q':
+			quiet = 1;
+			break;
+			default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+	if (optind != argc - 1) {
+		usage(argv[0]);
+		return 1;
+	}
+	if (!readStream(argv[optind])) { return 1; }
+	int hello = nextRecord(0, EV_HELLO);
+	if (hello < 0 || records[hello].data[0] != EV_VERSION || records[hello].data[1] != NUMSEATS) {
+		fprintf(stderr, "%s: stream was not recorded from reset by a version %d, %d seat build\n", argv[optind], EV_VERSION, NUMSEATS);
+		return 1;
+	}
+
+	// the same start as the firmware's main(), the shoe is unshuffled and the PRNG at its reset state
+	initDeck();
+	gameStart();
+	int state = nextRecord(hello, EV_STATE), seed = hello, input = hello;
+	unsigned long seen = 0, steps = 0, engineTime = 0, renderTime = 0, thinkMs = 0, sent = txQueued;
+	while (state >= 0) {
+		record *r = &records[state];
+		if (r->data[0] != game.state || r->data[1] != (unsigned char) game.player || (r->data[2] | (r->data[3] << 8)) != game.round) {
+			printf("replay left the recording at step %lu: recorded state %d player %d round %d, replay is at state %d player %d round %d\n",
+				steps, r->data[0], r->data[1], r->data[2] | (r->data[3] << 8), game.state, game.player, game.round);
+			return 2;
+		}
+		if (game.state == ST_ROUND) { // gameShow() stirs in the noise the firmware recorded
+			seed = nextRecord(seed + 1, EV_SEED);
+			if (seed < 0) { break; } // recording ends before this round was played
+			unsigned char *d = records[seed].data;
+			rngSeed(d[0] | ((unsigned long) d[1] << 8) | ((unsigned long) d[2] << 16) | ((unsigned long) d[3] << 24));
+		}
+		int in = ERROR;
+		if (gameNeedsInput()) {
+			input = nextRecord(input + 1, EV_INPUT);
+			if (input < 0) { break; } // recording ends while the seat was deciding
+			unsigned char *d = records[input].data;
+			if (d[0] != game.state) {
+				printf("replay left the recording at step %lu: input was for state %d, replay is at state %d\n", steps, d[0], game.state);
+				return 2;
+			}
+			in = d[1];
+			thinkMs += d[2] | (d[3] << 8);
+		}
+		unsigned long start = replayNow();
+		unsigned char next = gameStep(in);
+		engineTime += replayNow() - start;
+		if (errors != seen) {
+			seen = errors;
+			if (!quiet) { printf("round %d: engine error %d in state %d\n", game.round, engineErr, next); }
+		}
+		screen s;
+		memcpy_P(&s, &screens[next], sizeof(s));
+		start = replayNow();
+		if (s.draw) { s.draw(s.msg); }
+		renderTime += replayNow() - start;
+		steps++;
+		state = nextRecord(state + 1, EV_STATE);
+	}
+
+	unsigned long recorded = 0;
+	for (int i = 0; i < numRecords; i++) { recorded += records[i].type == EV_ERROR; }
+	printf("replayed %lu steps to round %d, %lu engine errors, %lu recorded\n", steps, game.round, errors, recorded);
+	printf("engine %lu ns, render %lu ns, %lu bytes to %s terminal, seats thought for %lu ms\n",
+		engineTime, renderTime, txQueued - sent, termAnsi ? "an ANSI" : "a dumb", thinkMs);
+	return errors != recorded ? 2 : 0;
+}
+// loads the packets of a saved stream, bytes outside packets such as the offers are skipped
+int readStream(const char *file) {
+	FILE *in = fopen(file, "rb");
+	if (!in) {
+		perror(file);
+		return 0;
+	}
+	int c;
+	while ((c = fgetc(in)) != EOF) {
+		if (c != EV_SYNC) { continue; }
+		long at = ftell(in); // a packet that fails its check is skipped one byte at a time, like tapview does
+		int type = fgetc(in), len = fgetc(in);
+		if (type == EOF || len == EOF || len > EV_MAXLEN) {
+			fseek(in, at, SEEK_SET);
+			continue;
+		}
+		record *r = &records[numRecords];
+		unsigned char sum = type + len;
+		int ok = fread(r->data, 1, len, in) == (size_t) len && (c = fgetc(in)) != EOF;
+		for (int i = 0; ok && i < len; i++) { sum += r->data[i]; }
+		if (!ok || (unsigned char) (sum + c) != 0) {
+			fseek(in, at, SEEK_SET);
+			continue;
+		}
+		if (numRecords == MAXRECORDS) {
+			fprintf(stderr, "%s: more than %d packets\n", file, MAXRECORDS);
+			break;
+		}
+		r->type = type;
+		r->len = len;
+		numRecords++;
+	}
+	fclose(in);
+	return 1;
+}
+// index of the first packet of a type at or after from, -1 = none
+int nextRecord(int from, unsigned char type) {
+	for (int i = from; i < numRecords; i++) {
+		if (records[i].type == type) { return i; }
+	}
+	return -1;
+}
+// the replay has no use for the firmware's tick, holds are what it leaves out
+unsigned long replayNow() {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1000000000UL + t.tv_nsec;
+}
+// counts an error, the firmware still shows it on its next screen
+void engineError(unsigned char code) {
+	errors++;
+	tapjackEngineError(code);
+}
+void usage(const char *prog) {
+	fprintf(stderr, "usage: %s [-d] [-q] stream\n"
+		"  replays a stream saved with view/tapview -r, -d draws for a dumb terminal, -q leaves out the error lines\n", prog);
+}
@@ -0,0 +1,315 @@
+// TAPjack game engine
+// blackjack rules and the state machine that runs a round
+// game logic designed by Nathan Ramos
+
+#include "engine.h"
+
+// global vars
+ENGINE_LOCAL card shoeG[SHOESIZE]; // cards in the order they will be dealt
+ENGINE_LOCAL uint16_t indexG; // index of next card in the shoe
+ENGINE_LOCAL uint32_t rngState = 1; // xorshift state, never 0
+
+ENGINE_LOCAL seat seats[NUMSEATS]; // every player has a main hand and an extra hand for a split scenario
+ENGINE_LOCAL hand dealer; // dealer's hand
+ENGINE_LOCAL table game; // where the current round is
+
+// state steps, each one leaves its state and returns the next
+unsigned char stepRound(int input);
+unsigned char stepTurn(int input);
+unsigned char stepSplit(int input);
+unsigned char stepSplitting(int input);
+unsigned char stepAction(int input);
+unsigned char stepHit(int input);
+unsigned char stepHandDone(int input);
+unsigned char stepDealer(int input);
+unsigned char stepDealerHit(int input);
+unsigned char stepSettle(int input);
+unsigned char stepResults(int input);
+unsigned char stepOver(int input);
+unsigned char evalHand(); // state the active hand calls for
+unsigned char nextHand(); // move on to the next hand or player
+int roundSettled(); // true if every player hand has busted
+unsigned int randBelow(unsigned int n); // unbiased random number from 0 to n - 1
+
+const stateRule stateTable[NUMSTATES] = {
+	[ST_ROUND]       = { 0, stepRound },
+	[ST_TURN]        = { 0, stepTurn },
+	[ST_SPLIT]       = { 1, stepSplit },
+	[ST_SPLITTING]   = { 0, stepSplitting },
+	[ST_ACTION]      = { 1, stepAction },
+	[ST_HIT]         = { 0, stepHit },
+	[ST_STAY]        = { 0, stepHandDone },
+	[ST_BUST]        = { 0, stepHandDone },
+	[ST_TAPJACK]     = { 0, stepHandDone },
+	[ST_DEALER]      = { 0, stepDealer },
+	[ST_DEALER_HIT]  = { 0, stepDealerHit },
+	[ST_DEALER_STAY] = { 0, stepSettle },
+	[ST_DEALER_BUST] = { 0, stepSettle },
+	[ST_DEALER_SKIP] = { 0, stepSettle },
+	[ST_RESULTS]     = { 0, stepResults },
+	[ST_OVER]        = { 0, stepOver },
+};
+
+// resets the engine so that the next state is the start of round 1
+void gameStart() {
+	game.state = ST_ROUND;
+	game.round = 1;
+	game.player = P1;
+	game.active = &seats[0].hands[0];
+	game.askSplit = 0;
+	game.settled = 0;
+}
+// true if the current state can only be left with HIT or STAY
+int gameNeedsInput() {
+	return stateTable[game.state].input;
+}
+// leaves the current state, input is HIT or STAY for states that wait for it
+// returns the state the round is in now
+unsigned char gameStep(int input) {
+	game.state = stateTable[game.state].step(input);
+	return game.state;
+}
+// starts a new round and deals out the starting hands in proper casino order
+unsigned char stepRound(int input) {
+	newRound();
+	for (int i = 0; i < 2; i++) {
+		for (seat *s = seats; s < seats + NUMSEATS; s++) { dealCard(&s->hands[0]); }
+		dealCard(&dealer);
+	}
+	dealer.cards[0] |= CARD_DOWN; // hide dealer's first card from view
+	game.player = P1;
+	game.settled = 0;
+	return ST_TURN;
+}
+// starts the current player's turn on their first hand
+unsigned char stepTurn(int input) {
+	game.active = &seatOf(game.player)->hands[0];
+	game.askSplit = 1;
+	return evalHand();
+}
+// player answered the split offer, HIT for yes
+unsigned char stepSplit(int input) {
+	game.askSplit = 0;
+	if (input == HIT) { return ST_SPLITTING; }
+	return evalHand();
+}
+// splits the player's pair and deals a new card to each hand
+unsigned char stepSplitting(int input) {
+	seat *s = seatOf(game.player);
+	split(&s->hands[0], &s->hands[1]);
+	dealCard(&s->hands[0]);
+	dealCard(&s->hands[1]);
+	return evalHand();
+}
+// player chose to hit or stay
+unsigned char stepAction(int input) {
+	if (input == HIT) { return ST_HIT; }
+	return ST_STAY;
+}
+// deals the card the player hit for
+unsigned char stepHit(int input) {
+	dealCard(game.active);
+	return evalHand();
+}
+// active hand stayed, busted or reached 21
+unsigned char stepHandDone(int input) {
+	return nextHand();
+}
+// decides whether the dealer draws again
+unsigned char stepDealer(int input) {
+	if (game.settled && !SETTLED_DRAW) { // every player already lost, drawing would only take time
+		return ST_DEALER_SKIP;
+	} else if (dealer.busted) { // dealer busts
+		return ST_DEALER_BUST;
+	} else if ((dealer.handvalue < 17) || (dealer.handvalue == 17 && dealer.soft && HIT_SOFT17)) { // dealer can continue drawing
+		return ST_DEALER_HIT;
+	}
+	return ST_DEALER_STAY; // dealer has reached a hand value from hard 17 up to 21
+}
+// deals the card the dealer hit for
+unsigned char stepDealerHit(int input) {
+	dealCard(&dealer);
+	return ST_DEALER;
+}
+// dealer is done, every hand is settled by handResult() when the results are shown
+unsigned char stepSettle(int input) {
+	return ST_RESULTS;
+}
+// moves on to the next round until every round has been played
+unsigned char stepResults(int input) {
+	if (game.round >= MAXROUNDS) { return ST_OVER; }
+	game.round++;
+	return ST_ROUND;
+}
+// game is over and stays over
+unsigned char stepOver(int input) {
+	return ST_OVER;
+}
+// picks the state for the active hand from its cards
+unsigned char evalHand() {
+	hand *p = game.active;
+	if ((cardRank(p->cards[0]) == cardRank(p->cards[1])) && game.askSplit) { // player's hand has the option to split
+		return ST_SPLIT;
+	} else if (p->busted) { // player's hand is worth more than 21
+		return ST_BUST;
+	} else if (p->handvalue == 21) { // player's hand is worth 21
+		return ST_TAPJACK;
+	}
+	return ST_ACTION; // player can hit or stay
+}
+// moves to the player's split hand, the next player, or the dealer
+unsigned char nextHand() {
+	seat *s = seatOf(game.player);
+	if (game.active == &s->hands[0] && !s->hands[1].empty) { // player's turn for their second hand
+		game.active = &s->hands[1];
+		return evalHand();
+	}
+	if (game.player < NUMSEATS) {
+		game.player++;
+		return ST_TURN;
+	}
+	game.player = DEALER;
+	game.active = &dealer;
+	game.settled = roundSettled();
+	dealer.cards[0] &= ~CARD_DOWN; // show dealer's first card
+	return ST_DEALER;
+}
+// true if every player hand has busted, a bust loses whatever the dealer ends up with
+// 21 is not settled since the dealer can still push it
+int roundSettled() {
+	for (seat *s = seats; s < seats + NUMSEATS; s++) {
+		for (int i = 0; i < SEATHANDS; i++) {
+			if (!s->hands[i].empty && !s->hands[i].busted) { return 0; }
+		}
+	}
+	return 1;
+}
+// empties given hand
+void emptyHand(hand *p) {
+    for (int i = 0; i < MAXHAND; i++) {
+		p->cards[i] = 0;
+	}
+	p->handsize = 0;
+	p->handvalue = 0;
+	p->busted = 0;
+	p->soft = 0;
+    p->empty = 1;
+}
+// initializes everybody's hands, shuffles the shoe only once the cut card has come up
+void newRound() {
+    emptyHand(&dealer);
+	for (seat *s = seats; s < seats + NUMSEATS; s++) {
+		for (int i = 0; i < SEATHANDS; i++) { emptyHand(&s->hands[i]); }
+	}
+	if (indexG >= CUTCARD) { shuffleDeck(); }
+}
+// fills the shoe with standard 52 card poker decks
+// the shoe starts out past the cut card so the first round shuffles it
+void initDeck() {
+	for (int i = 0; i < SHOESIZE; i++) {
+		shoeG[i] = i % SINGLEDECK; // hearts, diamonds, clubs, spades, each Ace to King
+	}
+	indexG = SHOESIZE;
+	// EXTREME TAPJACK: ACE OF SPADES
+// 	for (int i = 0; i < SHOESIZE; i++) {
+// 		shoeG[i] = SUIT_SPADES * MAXSUIT;
+// 	}
+}
+// shuffles every card of the shoe back in
+// the shuffle itself is a Fisher-Yates done one step per card in dealCard(), so this costs nothing between rounds
+void shuffleDeck() {
+    indexG = 0;
+}
+// mixes noise gathered through lavaRND into the PRNG without throwing away what it already has
+void rngSeed(uint32_t noise) {
+	rngState ^= noise;
+	if (rngState == 0) { rngState = 1; } // xorshift would stay stuck at 0
+	for (int i = 0; i < 8; i++) { rngNext(); } // spread the new bits through the state
+}
+// 32 bit xorshift, period 2^32 - 1
+uint32_t rngNext() {
+	uint32_t x = rngState;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	rngState = x;
+	return x;
+}
+// random number from 0 to n - 1
+// draws below 2^32 % n would favour the low numbers, they are thrown away and drawn again
+unsigned int randBelow(unsigned int n) {
+	uint32_t skip = (uint32_t)(0 - (uint32_t)n) % n;
+	uint32_t r;
+	do {
+		r = rngNext();
+	} while (r < skip);
+	return r % n;
+}
+// deal one available card from the deck to the given player
+// also updates their handsize, handvalue, and other hand characteristics
+void dealCard(hand *p) {
+    if (p->handsize >= MAXHAND) {
+		engineError(ERR_DEAL);
+		return;
+	}
+	if (indexG >= SHOESIZE) { // cut card was set too deep for this round, cards still on the table may come up again
+		shuffleDeck();
+	}
+	unsigned int j = indexG + randBelow(SHOESIZE - indexG); // pick from the cards not dealt yet
+	card c = shoeG[j];
+	shoeG[j] = shoeG[indexG];
+	shoeG[indexG] = c;
+	p->cards[p->handsize] = c;
+	p->handsize++;
+	indexG++;
+	p->handvalue += cardPoints(c);
+	if (cardRank(c) == 1) { p->soft++; }
+	if (p->handvalue > 21) {
+		if (p->soft > 0) {
+			p->handvalue -= 10;
+			p->soft--;
+		}
+		else { p->busted = 1; }
+	}
+    p->empty = 0;
+}
+// blackjack value of given card, Aces count 11 until a hand needs them to be 1
+uint8_t cardPoints(card c) {
+	uint8_t rank = cardRank(c);
+	switch (rank) {
+		case 1:
+		return 11;
+		case 10:
+		case 11:
+		case 12:
+		case 13:
+		return 10;
+		default:
+		return rank;
+	}
+}
+// splits a pair by moving the second card of pA into the empty hand pB
+// both hands are left with one card each, valued from scratch
+void split(hand *pA, hand *pB) {
+    card c = pA->cards[1];
+    pB->cards[0] = c;
+    pB->handsize = 1;
+    pB->handvalue = cardPoints(c);
+    pB->soft = (cardRank(c) == 1);
+    pB->empty = 0;
+    pA->cards[1] = 0;
+    pA->handsize = 1;
+    pA->handvalue = cardPoints(pA->cards[0]);
+    pA->soft = (cardRank(pA->cards[0]) == 1);
+}
+// compares given hand against the dealer's
+int handResult(hand *p) {
+	if (p->busted) {
+		return LOSS;
+	} else if (p->handvalue == dealer.handvalue) {
+		return PUSH;
+	} else if (p->handvalue < dealer.handvalue && !dealer.busted) {
+		return LOSS;
+	}
+	return WIN; // player's hand is worth more or dealer busted
+}
@@ -0,0 +1,145 @@
+// TAPjack game engine
+// blackjack rules and the state machine that runs a round
+// has no hardware access so the same code runs on the board and on a host
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdint.h>
+
+// blackjack constants
+#ifndef NUMSEATS
+#define NUMSEATS 4 // players at the table, seats P1 to NUMSEATS, one hand plus a split hand each
+#endif
+#define NUMPLAYERS (NUMSEATS + 1) // seats and the dealer, indexed by player ID
+#define SEATHANDS 2 // hands a seat can play, the second one only after a split
+#define SINGLEDECK 52
+#ifndef NUMDECKS
+#define NUMDECKS 4 // decks in the shoe, one byte of SRAM per card
+#endif
+#define SHOESIZE (NUMDECKS * SINGLEDECK)
+#ifndef PENETRATION
+#define PENETRATION 75 // percent of the shoe dealt before the cut card comes up
+#endif
+#define CUTCARD (SHOESIZE * PENETRATION / 100) // shoe is reshuffled before the round after this card
+#ifndef HIT_SOFT17
+#define HIT_SOFT17 1 // true = dealer hits soft 17, false = dealer stays on every 17
+#endif
+#ifndef SETTLED_DRAW
+#define SETTLED_DRAW 0 // true = dealer still draws out a round every player has already lost, false = dealer's play is skipped
+#endif
+#define MAXSUIT 13
+#define MAXRANK 4
+#define MAXHAND 12
+#define MAXROUNDS 999
+
+// DO NOT CHANGE
+#define HIT 1
+#define STAY 2
+#define NOACTION 3
+#define ERROR 0
+#define DEALER 0
+#define P1 1 // first seat, the rest follow up to NUMSEATS
+// outcome of a hand
+#define LOSS 0
+#define WIN 1
+#define PUSH 2
+// engine errors reported through engineError()
+#define ERR_DEAL 1 // hand is full
+
+// packed card, one byte each
+// bits 0-5 hold the card's index in a sorted deck (suit * MAXSUIT + rank - 1), bit 7 is set while it is face down
+typedef uint8_t card;
+#define CARD_INDEX 0x3F
+#define CARD_DOWN 0x80
+#define cardRank(c) (((c) & CARD_INDEX) % MAXSUIT + 1) // 1 = Ace, 2-9, 10 = T, 11 = Jack, 12 = Queen, 13 = King
+#define cardSuit(c) (((c) & CARD_INDEX) / MAXSUIT) // SUIT_*, an index past the deck gives an unknown suit
+#define SUIT_HEARTS 0 // same order as the card art rows
+#define SUIT_DIAMONDS 1
+#define SUIT_CLUBS 2
+#define SUIT_SPADES 3
+
+// round states, see stateTable in engine.c
+#define ST_ROUND 0 // round is about to start, cards get dealt
+#define ST_TURN 1 // a player's turn starts
+#define ST_SPLIT 2 // player may split their pair, waits for HIT (yes) or STAY (no)
+#define ST_SPLITTING 3 // player chose to split
+#define ST_ACTION 4 // player chooses HIT or STAY
+#define ST_HIT 5 // player hit, card is dealt when leaving this state
+#define ST_STAY 6 // player stayed
+#define ST_BUST 7 // player's hand is worth more than 21
+#define ST_TAPJACK 8 // player's hand is worth 21
+#define ST_DEALER 9 // dealer's cards are shown
+#define ST_DEALER_HIT 10 // dealer hits, card is dealt when leaving this state
+#define ST_DEALER_STAY 11 // dealer reached hard 17 up to 21
+#define ST_DEALER_BUST 12 // dealer's hand is worth more than 21
+#define ST_DEALER_SKIP 13 // every player hand busted, dealer does not draw
+#define ST_RESULTS 14 // every hand has been settled
+#define ST_OVER 15 // all rounds have been played
+#define NUMSTATES 16
+
+typedef struct hand {
+	card cards[MAXHAND]; // cards in the order they were dealt
+	uint8_t handsize; // number of cards in one player's hand
+	uint8_t handvalue; // how many points the player's hand is worth
+	uint8_t busted; // true = hand value over 21, false = hand value 21 or under
+	uint8_t soft; // true = hand value can decrease to stay under 22 (has Aces), false = hand value cannot decrease
+	uint8_t empty; // true = hand has zero cards, false = hand has at least one card
+	} hand;
+
+typedef struct seat {
+	hand hands[SEATHANDS]; // main hand, then the hand split off it
+	} seat;
+
+typedef struct table {
+	unsigned char state; // ST_* the round is in
+	int player; // P1 to NUMSEATS whose turn it is, DEALER once players are done
+	hand *active; // hand the current state applies to
+	int askSplit; // true = player has not been offered a split yet
+	int round; // rounds started so far
+	int settled; // true = every player hand busted, nothing the dealer draws can change the results
+	} table;
+
+typedef struct stateRule {
+	unsigned char input; // true = state waits for HIT or STAY
+	unsigned char (*step)(int input); // leaves the state, returns the next one
+	} stateRule;
+
+// storage class of the engine's state, a host build can make it thread local to run one engine per thread
+#ifndef ENGINE_LOCAL
+#define ENGINE_LOCAL
+#endif
+
+// seat of given player ID, P1 to NUMSEATS
+#define seatOf(ID) (&seats[(ID) - P1])
+
+// global vars
+extern ENGINE_LOCAL card shoeG[SHOESIZE];
+extern ENGINE_LOCAL uint16_t indexG;
+extern ENGINE_LOCAL seat seats[NUMSEATS];
+extern ENGINE_LOCAL hand dealer;
+extern ENGINE_LOCAL table game;
+
+// state machine
+void gameStart(); // first round is next
+int gameNeedsInput(); // does current state wait for HIT or STAY
+unsigned char gameStep(int input); // leave current state, returns the new one
+
+// reset logic
+void emptyHand(hand *p); // empty player's hand
+void newRound(); // starts a brand new round of blackjack
+void initDeck(); // fill the shoe with NUMDECKS decks of 52 playing cards
+void shuffleDeck(); // shuffle the whole shoe
+void rngSeed(uint32_t noise); // mix noise into the shuffler's PRNG
+uint32_t rngNext(); // next number from the shuffler's PRNG
+
+// game logic
+void dealCard(hand *p); // deal 1 card
+uint8_t cardPoints(card c); // blackjack value of a card, Aces count 11
+void split(hand *pA, hand *pB); // move second card of pA into pB
+int handResult(hand *p); // WIN, LOSS or PUSH against the dealer
+
+// implemented by whatever runs the engine
+void engineError(unsigned char code); // report ERR_*
+
+#endif
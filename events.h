@@ -0,0 +1,46 @@
+// TAPjack event stream, shared by the firmware and the host front end in view/
+// instead of drawing screens the firmware can send what happened in the game as small packets
+// and leave the drawing to a host, see eventShow() in TAPjack.c and view/tapview.c
+// the stream also carries every seed and decision, so a saved one replays the session, see bench/replay.c
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+// a host that reads events answers EV_ACCEPT to this offer, sent in an APC string that ordinary terminals ignore
+#define EV_OFFER "\x1B_TAPjack events\x1B\\"
+#define EV_ACCEPT 'E'
+#define EV_VERSION 2 // changes whenever a packet changes
+
+// before the offer a firmware built with BAUD_FAST offers a faster link, see USART_upgrade() in TAPjack.c:
+// the rate follows the offer in decimal, then ESC \, a host that can follow answers BAUD_ACCEPT, switches
+// its port and sends BAUD_CONFIRM at the new rate, without it the firmware goes back to its reset rate
+#define BAUD_OFFER "\x1B_TAPjack baud="
+#define BAUD_ACCEPT 'B'
+#define BAUD_CONFIRM 'K'
+
+// packet: EV_SYNC, type, payload length, payload, check
+// check makes type, length, payload and check add up to 0, a host resyncs on the next EV_SYNC after a bad one
+#define EV_SYNC 0xA5
+#define EV_MAXLEN 16 // longest payload, a full hand
+
+// packet types and their payloads
+#define EV_HELLO 1 // EV_VERSION, NUMSEATS, SEATHANDS, sent once when the host accepts
+#define EV_STATE 2 // ST_* the round entered, player (DEALER = 0), round low byte, round high byte
+#define EV_HAND 3 // hand id, value, EVH_* flags, then one byte per card, a face down card is sent as CARD_DOWN
+#define EV_RESULT 4 // hand id, WIN, LOSS or PUSH
+#define EV_ADVICE 5 // HIT or STAY, what basic strategy would do with the question being asked
+#define EV_ERROR 6 // ERR_* reported by the engine
+#define EV_SEED 7 // noise mixed into the shuffler's PRNG as a round starts, 4 bytes low byte first
+#define EV_INPUT 8 // ST_* that asked, HIT or STAY, ms since the question went up low byte, high byte
+
+// hand ids, 0 is the dealer, then each seat's hands in order
+#define EV_DEALER 0
+#define evHandId(ID, i) (1 + ((ID) - P1) * SEATHANDS + (i))
+#define EV_HANDS (1 + NUMSEATS * SEATHANDS)
+
+// EV_HAND flags
+#define EVH_SOFT 0x01
+#define EVH_BUSTED 0x02
+#define EVH_HIDDEN 0x04 // a card is face down, value is 0 so it gives nothing away
+
+#endif
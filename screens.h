@@ -0,0 +1,62 @@
+// static screens for the TAPjack terminal, compressed for frameScreen_P()
+// generated by sim/tapscreens from sim/screens.txt, run make screens in sim/ after changing the art
+
+#ifndef SCREENS_H
+#define SCREENS_H
+
+#define SCREEN_WIDTH 165 // TERMWIDTH the screens were centered for
+#define SCR_END 0x00 // end of screen
+#define SCR_FIELD 0x01 // the field passed to frameScreen_P()
+#define SCR_ROWS 0x02 // next byte is a count of blank rows
+#define SCR_COPY 0x10 // 0x10-0x1F copy (token & 0x0F) + SCR_COPY_MIN chars, next byte is how far back they start
+#define SCR_COPY_MIN 3
+#define SCR_RUN 0x80 // 0x81-0xFF run of (token & 0x7F) blanks, anything else is a char drawn as itself
+
+// intro, 776 chars in 283 bytes
+const char screenIntro[] PROGMEM = {
+	0x0A, 0x0A, 0xBC, 0x57, 0x45, 0x4C, 0x43, 0x4F, 0x4D, 0x45, 0x20, 0x54, 0x4F, 0x10, 0x03, 0x55,
+	0x43, 0x48, 0x4C, 0x45, 0x53, 0x53, 0x20, 0x41, 0x55, 0x54, 0x4F, 0x4D, 0x41, 0x54, 0x45, 0x44,
+	0x20, 0x50, 0x4C, 0x41, 0x59, 0x20, 0x42, 0x4C, 0x41, 0x43, 0x4B, 0x4A, 0x10, 0x04, 0x0A, 0xD1,
+	0x41, 0x4B, 0x41, 0x0A, 0xAF, 0x20, 0x5F, 0x5F, 0x5F, 0x10, 0x03, 0x83, 0x10, 0x06, 0x10, 0x08,
+	0x85, 0x10, 0x0B, 0x10, 0x0D, 0x85, 0x5F, 0x5F, 0x85, 0x10, 0x13, 0x10, 0x15, 0x85, 0x10, 0x18,
+	0x10, 0x1A, 0x85, 0x5F, 0x5F, 0x82, 0x5F, 0x5F, 0x0A, 0xAF, 0x2F, 0x5C, 0x5F, 0x5F, 0x82, 0x5F,
+	0x5C, 0x20, 0x2F, 0x5C, 0x82, 0x5F, 0x5F, 0x20, 0x5C, 0x83, 0x2F, 0x5C, 0x82, 0x3D, 0x3D, 0x20,
+	0x5C, 0x83, 0x2F, 0x5C, 0x20, 0x5C, 0x83, 0x10, 0x05, 0x10, 0x44, 0x20, 0x5C, 0x83, 0x10, 0x0C,
+	0x11, 0x4B, 0x5C, 0x83, 0x11, 0x12, 0x2F, 0x20, 0x2F, 0x0A, 0xAF, 0x5C, 0x2F, 0x5F, 0x11, 0x1C,
+	0x2F, 0x20, 0x10, 0x1F, 0x82, 0x11, 0x30, 0x82, 0x10, 0x25, 0x82, 0x5F, 0x2D, 0x2F, 0x82, 0x5F,
+	0x5C, 0x10, 0x42, 0x5C, 0x82, 0x10, 0x32, 0x82, 0x11, 0x43, 0x82, 0x10, 0x38, 0x20, 0x10, 0x53,
+	0x10, 0x4B, 0x20, 0x10, 0x40, 0x82, 0x5F, 0x22, 0x2D, 0x2E, 0x0A, 0xAF, 0x83, 0x10, 0x4A, 0x10,
+	0x60, 0x20, 0x10, 0x4F, 0x10, 0x65, 0x5C, 0x10, 0x68, 0x20, 0x10, 0x57, 0x10, 0x6D, 0x82, 0x11,
+	0x75, 0x10, 0x9B, 0x5C, 0x82, 0x10, 0x62, 0x10, 0x78, 0x5C, 0x10, 0x7B, 0x20, 0x10, 0x6A, 0x10,
+	0xA9, 0x5F, 0x10, 0x83, 0x20, 0x10, 0x72, 0x10, 0x88, 0x5C, 0x5F, 0x5C, 0x0A, 0xAF, 0x84, 0x10,
+	0x64, 0x2F, 0x83, 0x10, 0x68, 0x2F, 0x10, 0x6B, 0x2F, 0x83, 0x10, 0x6F, 0x2F, 0x83, 0x10, 0x73,
+	0x10, 0xCA, 0x5F, 0x2F, 0x83, 0x10, 0x7A, 0x2F, 0x10, 0x7D, 0x2F, 0x83, 0x10, 0x81, 0x10, 0xD8,
+	0x5F, 0x2F, 0x83, 0x10, 0x88, 0x2F, 0x10, 0x8B, 0x2F, 0x0A, 0x00
+};
+
+// credits, 203 chars in 55 bytes
+const char screenCredits[] PROGMEM = {
+	0x02, 0x0D, 0xCD, 0x43, 0x52, 0x45, 0x41, 0x54, 0x45, 0x44, 0x20, 0x42, 0x59, 0x0A, 0xBF, 0x4E,
+	0x61, 0x74, 0x68, 0x61, 0x6E, 0x20, 0x52, 0x61, 0x6D, 0x6F, 0x73, 0x2C, 0x20, 0x4B, 0x65, 0x76,
+	0x69, 0x6E, 0x20, 0x4C, 0x65, 0x69, 0x2C, 0x20, 0x26, 0x20, 0x51, 0x75, 0x69, 0x6E, 0x6E, 0x20,
+	0x46, 0x72, 0x61, 0x64, 0x79, 0x0A, 0x00
+};
+
+// round, 102 chars in 12 bytes
+const char screenRound[] PROGMEM = {
+	0x02, 0x0F, 0xCF, 0x52, 0x6F, 0x75, 0x6E, 0x64, 0x20, 0x01, 0x0A, 0x00
+};
+
+// turn, 106 chars in 20 bytes
+const char screenTurn[] PROGMEM = {
+	0x02, 0x0F, 0xCB, 0x50, 0x4C, 0x41, 0x59, 0x45, 0x52, 0x20, 0x01, 0x27, 0x53, 0x20, 0x54, 0x55,
+	0x52, 0x4E, 0x0A, 0x00
+};
+
+// dealerTurn, 105 chars in 18 bytes
+const char screenDealerTurn[] PROGMEM = {
+	0x02, 0x0F, 0xCC, 0x44, 0x45, 0x41, 0x4C, 0x45, 0x52, 0x27, 0x53, 0x20, 0x54, 0x55, 0x52, 0x4E,
+	0x0A, 0x00
+};
+
+#endif
@@ -0,0 +1,233 @@
+// TAPjack static screen generator
+// reads the art in screens.txt and prints each screen as a compressed PROGMEM blob for screens.h,
+// the firmware's frameScreen_P() decodes them straight from flash into the terminal renderer
+// a screen is a row per line, centered on the terminal: rows starting with | are centered together as a block
+// by the widest of them, and $ marks a field the firmware fills in when it draws
+// runs of blanks become one byte and repeated text becomes a copy of an earlier stretch of the same blob
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAXSCREENS 16
+#define MAXROWS 28
+#define MAXLINE 256
+#define MAXBLOB 2048
+#define MAXNAME 32
+
+// tokens, kept in step with the decoder through the defines printed into screens.h
+#define SCR_END 0x00 // end of screen
+#define SCR_FIELD 0x01 // the field passed to frameScreen_P()
+#define SCR_ROWS 0x02 // next byte is a count of blank rows
+#define SCR_NL 0x0A // end of row
+#define SCR_COPY 0x10 // 0x10-0x1F copy (token & 0x0F) + COPY_MIN chars, next byte is how far back they start
+#define SCR_RUN 0x80 // 0x81-0xFF run of (token & 0x7F) blanks
+#define COPY_MIN 3 // a copy takes two bytes, so shorter repeats stay literal
+#define COPY_MAX (COPY_MIN + 15)
+#define COPY_BACK 255
+#define RUN_MAX 127
+#define BLANK_MIN 3 // blank rows worth a count, fewer are sent as row ends
+
+typedef struct screen {
+	char name[MAXNAME];
+	char rows[MAXROWS][MAXLINE];
+	int numRows;
+	} screen;
+
+screen screens[MAXSCREENS];
+int numScreens = 0;
+int width = 165; // terminal width the screens are centered for
+
+unsigned char blob[MAXBLOB];
+unsigned char literal[MAXBLOB]; // blob[i] is a char drawn as itself, only those can be copied
+int blobLen;
+
+void readArt(FILE *in); // read every screen from the art file
+int blockWidth(screen *s, int row); // width row is centered by
+void encode(screen *s); // compress one screen into blob[]
+void emit(unsigned char b, int lit); // append one byte to blob[]
+int bestCopy(const char *text, int len, int *back); // longest earlier stretch of blob[] matching text
+void printScreen(screen *s); // print one screen as a PROGMEM array
+void usage(const char *prog);
+
+int main(int argc, char **argv) {
+	int opt;
+	while ((opt = getopt(argc, argv, "w:h")) != -1) {
+		switch (opt) {
+			case 'w':
+			width = atoi(optarg);
+			break;
+			default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+	FILE *in = optind < argc ? fopen(argv[optind], "r") : stdin;
+	if (!in) {
+		perror(argv[optind]);
+		return 1;
+	}
+	readArt(in);
+	if (in != stdin) { fclose(in); }
+
+	printf("// static screens for the TAPjack terminal, compressed for frameScreen_P()\n");
+	printf("// generated by sim/tapscreens from sim/screens.txt, run make screens in sim/ after changing the art\n\n");
+	printf("#ifndef SCREENS_H\n#define SCREENS_H\n\n");
+	printf("#define SCREEN_WIDTH %d // TERMWIDTH the screens were centered for\n", width);
+	printf("#define SCR_END 0x%02X // end of screen\n", SCR_END);
+	printf("#define SCR_FIELD 0x%02X // the field passed to frameScreen_P()\n", SCR_FIELD);
+	printf("#define SCR_ROWS 0x%02X // next byte is a count of blank rows\n", SCR_ROWS);
+	printf("#define SCR_COPY 0x%02X // 0x%02X-0x%02X copy (token & 0x0F) + SCR_COPY_MIN chars, next byte is how far back they start\n",
+		SCR_COPY, SCR_COPY, SCR_COPY + 15);
+	printf("#define SCR_COPY_MIN %d\n", COPY_MIN);
+	printf("#define SCR_RUN 0x%02X // 0x%02X-0xFF run of (token & 0x7F) blanks, anything else is a char drawn as itself\n",
+		SCR_RUN, SCR_RUN + 1);
+	for (int i = 0; i < numScreens; i++) { printScreen(&screens[i]); }
+	printf("\n#endif\n");
+	return 0;
+}
+// reads screens as "= name" followed by its rows, lines starting with # are comments
+void readArt(FILE *in) {
+	char buf[MAXLINE + 2];
+	screen *s = NULL;
+	while (fgets(buf, sizeof(buf), in)) {
+		size_t n = strcspn(buf, "\r\n");
+		if (buf[n] == '\0' && !feof(in)) {
+			fprintf(stderr, "line longer than %d chars\n", MAXLINE);
+			exit(1);
+		}
+		buf[n] = '\0';
+		while (n > 0 && buf[n - 1] == ' ') { buf[--n] = '\0'; } // trailing blanks are never drawn
+		if (buf[0] == '#') { continue; }
+		if (buf[0] == '=') {
+			if (numScreens == MAXSCREENS) {
+				fprintf(stderr, "more than %d screens\n", MAXSCREENS);
+				exit(1);
+			}
+			s = &screens[numScreens++];
+			sscanf(buf + 1, " %31s", s->name);
+			continue;
+		}
+		if (!s) {
+			if (n > 0) {
+				fprintf(stderr, "art before the first \"= name\" line\n");
+				exit(1);
+			}
+			continue;
+		}
+		if (strchr(buf, '\t')) {
+			fprintf(stderr, "%s: tabs do not draw the same on every terminal, use spaces\n", s->name);
+			exit(1);
+		}
+		if (s->numRows == MAXROWS) {
+			fprintf(stderr, "%s: more than %d rows\n", s->name, MAXROWS);
+			exit(1);
+		}
+		strcpy(s->rows[s->numRows++], buf);
+	}
+	for (int i = 0; i < numScreens; i++) { // blank rows at the bottom are left to frameEnd()
+		while (screens[i].numRows > 0 && screens[i].rows[screens[i].numRows - 1][0] == '\0') { screens[i].numRows--; }
+	}
+}
+// width row is centered by, its own unless it is in a block of | rows, then the widest of them
+int blockWidth(screen *s, int row) {
+	int first = row, last = row, widest = 0;
+	if (s->rows[row][0] != '|') { return strlen(s->rows[row]); }
+	while (first > 0 && s->rows[first - 1][0] == '|') { first--; }
+	while (last < s->numRows - 1 && s->rows[last + 1][0] == '|') { last++; }
+	for (int r = first; r <= last; r++) {
+		int n = strlen(s->rows[r]) - 1;
+		if (n > widest) { widest = n; }
+	}
+	return widest;
+}
+// compresses one screen into blob[], a copy only ever reaches back into the same screen
+void encode(screen *s) {
+	int blanks = 0;
+	blobLen = 0;
+	for (int r = 0; r < s->numRows; r++) {
+		const char *text = s->rows[r];
+		int len = strlen(text);
+		int pad = (width - blockWidth(s, r)) / 2;
+		if (text[0] == '|') {
+			text++;
+			len--;
+		}
+		if (len == 0) {
+			blanks++;
+			continue;
+		}
+		if (blanks >= BLANK_MIN) {
+			emit(SCR_ROWS, 0);
+			emit(blanks, 0);
+		} else {
+			for (; blanks > 0; blanks--) { emit(SCR_NL, 0); }
+		}
+		blanks = 0;
+		for (; pad > 0; pad -= RUN_MAX) { emit(SCR_RUN | (pad > RUN_MAX ? RUN_MAX : pad), 0); }
+		for (int i = 0; i < len;) {
+			int back, copy = bestCopy(text + i, len - i, &back);
+			int run = strspn(text + i, " ");
+			if (copy >= COPY_MIN && copy > run) {
+				emit(SCR_COPY | (copy - COPY_MIN), 0);
+				emit(back, 0);
+				i += copy;
+			} else if (run >= 2) {
+				if (run > RUN_MAX) { run = RUN_MAX; }
+				emit(SCR_RUN | run, 0);
+				i += run;
+			} else if (text[i] == '$') {
+				emit(SCR_FIELD, 0);
+				i++;
+			} else if (text[i] < ' ' || text[i] > '~') {
+				fprintf(stderr, "%s: only printable ASCII can be drawn\n", s->name);
+				exit(1);
+			} else {
+				emit(text[i++], 1);
+			}
+		}
+		emit(SCR_NL, 0);
+	}
+	emit(SCR_END, 0);
+}
+// appends one byte, lit says it is a char drawn as itself
+void emit(unsigned char b, int lit) {
+	if (blobLen == MAXBLOB) {
+		fprintf(stderr, "screen larger than %d bytes\n", MAXBLOB);
+		exit(1);
+	}
+	literal[blobLen] = lit;
+	blob[blobLen++] = b;
+}
+// longest stretch of literal chars already in blob[] that text starts with, back is how far before
+// the copy token it starts, fields never match since $ is not stored as a char
+int bestCopy(const char *text, int len, int *back) {
+	int best = 0;
+	for (int from = blobLen > COPY_BACK ? blobLen - COPY_BACK : 0; from < blobLen; from++) {
+		int n = 0;
+		while (n < len && n < COPY_MAX && from + n < blobLen && literal[from + n] && blob[from + n] == (unsigned char) text[n]) { n++; }
+		if (n > best) {
+			best = n;
+			*back = blobLen - from;
+		}
+	}
+	return best;
+}
+// prints one screen as const char screenName[] PROGMEM, name capitalised
+void printScreen(screen *s) {
+	int drawn = 0;
+	for (int r = 0; r < s->numRows; r++) {
+		int n = strlen(s->rows[r]);
+		if (s->rows[r][0] == '|') { n--; }
+		drawn += (n ? (width - blockWidth(s, r)) / 2 + n : 0) + 1;
+	}
+	encode(s);
+	printf("\n// %s, %d chars in %d bytes\n", s->name, drawn, blobLen);
+	printf("const char screen%c%s[] PROGMEM = {", s->name[0] & ~0x20, s->name + 1);
+	for (int i = 0; i < blobLen; i++) { printf("%s0x%02X%s", i % 16 ? " " : "\n\t", blob[i], i < blobLen - 1 ? "," : ""); }
+	printf("\n};\n");
+}
+void usage(const char *prog) {
+	fprintf(stderr, "usage: %s [-w terminal width] [screens.txt]\n", prog);
+}
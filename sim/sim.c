@@ -0,0 +1,284 @@
+// TAPjack host simulator
+// plays the engine's rounds at full speed with a computer strategy in every seat
+// and reports how the house does, to check rule changes before they go on a table
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "engine.h"
+
+#define MAXTHREADS 256
+
+// a player strategy answers HIT or STAY for the active hand
+// splitOffer is true when the question is whether to split the pair
+typedef int (*strategy)(hand *p, card up, int splitOffer);
+
+typedef struct player {
+	const char *name;
+	strategy decide;
+	const char *about;
+	} player;
+
+typedef struct stats {
+	unsigned long rounds; // rounds played to the end
+	unsigned long hands; // hands settled, a split adds one
+	unsigned long wins;
+	unsigned long losses;
+	unsigned long pushes;
+	unsigned long playerBusts; // hands that went over 21
+	unsigned long dealerBusts; // rounds the dealer went over 21
+	unsigned long settled; // rounds every player busted and the dealer did not draw
+	unsigned long splitOffers; // pairs that could have been split
+	unsigned long splits; // pairs that were split
+	unsigned long errors; // engineError() calls
+	} stats;
+
+typedef struct shard {
+	strategy decide;
+	unsigned long rounds; // rounds this thread plays
+	uint64_t seed; // start of this thread's noise stream
+	stats result;
+	pthread_t thread;
+	} shard;
+
+ENGINE_LOCAL stats sim; // counts for the engine running on this thread
+ENGINE_LOCAL uint64_t noise; // splitmix64 state standing in for the light sensor
+
+// strategies
+int stayAlways(hand *p, card up, int splitOffer);
+int hitLikeDealer(hand *p, card up, int splitOffer);
+int basicStrategy(hand *p, card up, int splitOffer);
+
+player players[] = {
+	{ "stay", stayAlways, "never hits or splits" },
+	{ "dealer", hitLikeDealer, "hits below 17 and soft 17, never splits" },
+	{ "basic", basicStrategy, "hit/stay/split from the advice tables in strategy.h" },
+};
+#define NUMSTRATEGIES (sizeof(players) / sizeof(players[0]))
+
+// simulator
+void *simShard(void *arg); // thread body, plays one shard on its own engine
+void simRun(strategy decide, unsigned long rounds); // play rounds and fill in sim
+void simSettle(); // count the results of the round that just ended
+void simAdd(stats *total, const stats *s); // add one shard's counts to the total
+uint32_t simNoise(); // next reseed value for this thread's engine
+void simReport(const stats *s, double seconds); // print what was counted
+double wallClock(); // seconds from a monotonic clock
+void tablesBuild(); // work out the advice tables, see tables.c
+void tablesPrint(); // print strategy.h, see tables.c
+extern unsigned int adviceHard[22], adviceSoft[22], adviceSplit[12]; // filled in by tablesBuild()
+void usage(const char *prog);
+
+// the engine reports errors through here, the simulator only counts them
+void engineError(unsigned char code) {
+	sim.errors++;
+}
+
+int main(int argc, char **argv) {
+	unsigned long rounds = 1000000;
+	unsigned long seed = (unsigned long)time(NULL);
+	long threads = 1;
+	player *who = &players[2];
+	int opt;
+	while ((opt = getopt(argc, argv, "n:s:p:j:gh")) != -1) {
+		switch (opt) {
+			case 'n':
+			rounds = strtoul(optarg, NULL, 10);
+			break;
+			case 'j':
+			threads = strtol(optarg, NULL, 10);
+			if (threads <= 0) { threads = sysconf(_SC_NPROCESSORS_ONLN); } // -j 0 uses every core
+			if (threads < 1) { threads = 1; }
+			if (threads > MAXTHREADS) { threads = MAXTHREADS; }
+			break;
+			case 's':
+			seed = strtoul(optarg, NULL, 0);
+			break;
+			case 'g':
+			tablesPrint();
+			return 0;
+			case 'p':
+			who = NULL;
+			for (unsigned int i = 0; i < NUMSTRATEGIES; i++) {
+				if (strcmp(optarg, players[i].name) == 0) { who = &players[i]; }
+			}
+			if (!who) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+			default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	tablesBuild(); // the basic player reads the same tables the firmware is built with
+	// every thread gets its own engine, shoe and noise stream, and an equal share of the rounds
+	static shard shards[MAXTHREADS];
+	for (long i = 0; i < threads; i++) {
+		shards[i].decide = who->decide;
+		shards[i].rounds = rounds / threads + (i < (long)(rounds % threads));
+		shards[i].seed = seed ^ ((uint64_t)i << 32);
+	}
+	double start = wallClock();
+	if (threads == 1) {
+		simShard(&shards[0]);
+	} else {
+		for (long i = 0; i < threads; i++) {
+			if (pthread_create(&shards[i].thread, NULL, simShard, &shards[i])) {
+				fprintf(stderr, "cannot start thread %ld\n", i);
+				return 1;
+			}
+		}
+		for (long i = 0; i < threads; i++) { pthread_join(shards[i].thread, NULL); }
+	}
+	double seconds = wallClock() - start;
+
+	stats total;
+	memset(&total, 0, sizeof(total));
+	for (long i = 0; i < threads; i++) { simAdd(&total, &shards[i].result); }
+	printf("strategy %s, seed %lu, %ld threads, %d decks, %d%% penetration, dealer %s soft 17\n",
+		who->name, seed, threads, NUMDECKS, PENETRATION, HIT_SOFT17 ? "hits" : "stays on");
+	simReport(&total, seconds);
+	return total.errors ? 2 : 0;
+}
+// plays one shard on this thread's engine
+void *simShard(void *arg) {
+	shard *s = arg;
+	noise = s->seed;
+	noise = ((uint64_t)simNoise() << 32) | simNoise(); // start each stream at a scrambled point so threads do not overlap
+	initDeck();
+	simRun(s->decide, s->rounds);
+	s->result = sim;
+	return NULL;
+}
+// plays the given number of rounds with every seat using the same strategy
+void simRun(strategy decide, unsigned long rounds) {
+	memset(&sim, 0, sizeof(sim));
+	gameStart();
+	rngSeed(simNoise());
+	while (sim.rounds < rounds) {
+		int input = ERROR;
+		if (gameNeedsInput()) {
+			input = decide(game.active, dealer.cards[1], game.state == ST_SPLIT);
+		}
+		switch (gameStep(input)) {
+			case ST_SPLIT:
+			sim.splitOffers++;
+			break;
+			case ST_SPLITTING:
+			sim.splits++;
+			break;
+			case ST_BUST:
+			sim.playerBusts++;
+			break;
+			case ST_DEALER_BUST:
+			sim.dealerBusts++;
+			break;
+			case ST_DEALER_SKIP:
+			sim.settled++;
+			break;
+			case ST_RESULTS:
+			simSettle();
+			break;
+			case ST_ROUND:
+			rngSeed(simNoise()); // like the firmware, stir new noise in every round
+			break;
+			case ST_OVER:
+			gameStart(); // engine stops after MAXROUNDS, keep the shoe and start over
+			break;
+		}
+	}
+}
+// counts every hand on the table against the dealer
+void simSettle() {
+	for (seat *s = seats; s < seats + NUMSEATS; s++) {
+		for (int i = 0; i < SEATHANDS; i++) {
+			hand *p = &s->hands[i];
+			if (p->empty) { continue; }
+			sim.hands++;
+			switch (handResult(p)) {
+				case WIN:  sim.wins++;   break;
+				case PUSH: sim.pushes++; break;
+				default:   sim.losses++; break;
+			}
+		}
+	}
+	sim.rounds++;
+}
+// adds one shard's counts to the total
+void simAdd(stats *total, const stats *s) {
+	total->rounds += s->rounds;
+	total->hands += s->hands;
+	total->wins += s->wins;
+	total->losses += s->losses;
+	total->pushes += s->pushes;
+	total->playerBusts += s->playerBusts;
+	total->dealerBusts += s->dealerBusts;
+	total->settled += s->settled;
+	total->splitOffers += s->splitOffers;
+	total->splits += s->splits;
+	total->errors += s->errors;
+}
+// splitmix64, gives each thread a long independent stream to reseed its engine's 32 bit xorshift from
+uint32_t simNoise() {
+	uint64_t z = (noise += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return (uint32_t)((z ^ (z >> 31)) >> 32);
+}
+// prints rates as a share of hands or rounds, house edge assumes one unit bet per hand paid even money
+void simReport(const stats *s, double seconds) {
+	double hands = s->hands ? s->hands : 1;
+	double rounds = s->rounds ? s->rounds : 1;
+	double played = s->rounds > s->settled ? s->rounds - s->settled : 1; // rounds the dealer drew out
+	printf("rounds       %lu\n", s->rounds);
+	printf("hands        %lu\n", s->hands);
+	printf("wins         %6.2f%%\n", 100.0 * s->wins / hands);
+	printf("losses       %6.2f%%\n", 100.0 * s->losses / hands);
+	printf("pushes       %6.2f%%\n", 100.0 * s->pushes / hands);
+	printf("house edge   %6.2f%%\n", 100.0 * ((double)s->losses - (double)s->wins) / hands);
+	printf("player busts %6.2f%% of hands\n", 100.0 * s->playerBusts / hands);
+	printf("dealer busts %6.2f%% of rounds played out\n", 100.0 * s->dealerBusts / played);
+	printf("settled      %6.2f%% of rounds before the dealer drew\n", 100.0 * s->settled / rounds);
+	printf("splits       %6.2f%% of offers, %.2f per 100 rounds\n",
+		s->splitOffers ? 100.0 * s->splits / s->splitOffers : 0.0, 100.0 * s->splits / rounds);
+	printf("errors       %lu\n", s->errors);
+	if (seconds > 0) { printf("speed        %.0f hands/s\n", s->hands / seconds); }
+}
+// seconds from a monotonic clock, for wall time across threads
+double wallClock() {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec / 1e9;
+}
+void usage(const char *prog) {
+	fprintf(stderr, "usage: %s [-n rounds] [-s seed] [-p strategy] [-j threads, 0 = every core]\n"
+		"       %s -g > ../strategy.h\n", prog, prog);
+	for (unsigned int i = 0; i < NUMSTRATEGIES; i++) {
+		fprintf(stderr, "  %-8s %s\n", players[i].name, players[i].about);
+	}
+}
+// never takes a card
+int stayAlways(hand *p, card up, int splitOffer) {
+	return STAY;
+}
+// plays the same rule the dealer has to
+int hitLikeDealer(hand *p, card up, int splitOffer) {
+	if (splitOffer) { return STAY; }
+	if (p->handvalue < 17 || (p->handvalue == 17 && p->soft)) { return HIT; }
+	return STAY;
+}
+// basic strategy without doubling or surrender, played from the tables in strategy.h the same way the firmware's adviceFor() does
+int basicStrategy(hand *p, card up, int splitOffer) {
+	unsigned int row;
+	if (splitOffer) { row = adviceSplit[cardPoints(p->cards[0])]; }
+	else if (p->soft) { row = adviceSoft[p->handvalue]; }
+	else if (p->handvalue < 4) { return HIT; }
+	else { row = adviceHard[p->handvalue]; }
+	return ((row >> (cardPoints(up) - 2)) & 1) ? HIT : STAY;
+}
@@ -0,0 +1,155 @@
+// TAPjack advice table generator
+// works out the dealer's final totals and the player's best play for every total and up card,
+// and prints them as the PROGMEM tables in strategy.h
+// uses an infinite deck, which is within a fraction of a percent of a 4 deck shoe and keeps the tables exact
+
+#include <stdio.h>
+#include <string.h>
+#include "engine.h"
+
+#define UPCARDS 10 // dealer up card worth 2-11
+#define OUT_BUST 5 // dealer outcome index, 0-4 are final totals 17-21
+#define NUMOUT 6
+
+double cardOdds[12]; // chance of drawing a card worth 2-11
+double dealerOut[12][NUMOUT]; // chance of each dealer outcome for an up card worth 2-11
+double bestMemo[2][32]; // best expected value of a player hand by [soft][total], for the up card being worked on
+int bestDone[2][32];
+unsigned int adviceHard[22], adviceSoft[22], adviceSplit[12]; // the tables strategy.h is printed from, by total or pair card worth 2-11
+
+// adds a card worth v to a total the same way dealCard() does
+void addCard(int *total, int *soft, int v) {
+	*total += v;
+	if (v == 11) { (*soft)++; }
+	if (*total > 21 && *soft > 0) {
+		*total -= 10;
+		(*soft)--;
+	}
+}
+// adds the chance of every dealer outcome from this total into out, scaled by odds
+void dealerFrom(int total, int soft, double odds, double *out) {
+	if (total > 21) {
+		out[OUT_BUST] += odds;
+		return;
+	}
+	if (total > 17 || (total == 17 && !(soft && HIT_SOFT17))) { // same rule as stepDealer()
+		out[total - 17] += odds;
+		return;
+	}
+	for (int v = 2; v <= 11; v++) {
+		int t = total, s = soft;
+		addCard(&t, &s, v);
+		dealerFrom(t, s, odds * cardOdds[v], out);
+	}
+}
+// expected value of staying on total against the up card's dealer outcomes
+double stayValue(int total, const double *out) {
+	if (total > 21) { return -1; }
+	double ev = out[OUT_BUST];
+	for (int f = 17; f <= 21; f++) {
+		if (f < total) { ev += out[f - 17]; }
+		else if (f > total) { ev -= out[f - 17]; }
+	}
+	return ev;
+}
+double bestValue(int total, int soft, const double *out);
+// expected value of taking one card and then playing on as well as possible
+double hitValue(int total, int soft, const double *out) {
+	double ev = 0;
+	for (int v = 2; v <= 11; v++) {
+		int t = total, s = soft;
+		addCard(&t, &s, v);
+		ev += cardOdds[v] * (t > 21 ? -1 : bestValue(t, s, out));
+	}
+	return ev;
+}
+// expected value of the better of hitting and staying, a hand worth 21 always stays like evalHand() makes it
+double bestValue(int total, int soft, const double *out) {
+	int s = soft > 0;
+	if (!bestDone[s][total]) {
+		double stay = stayValue(total, out);
+		double best = stay;
+		if (total < 21) {
+			double hit = hitValue(total, soft, out);
+			if (hit > stay) { best = hit; }
+		}
+		bestMemo[s][total] = best;
+		bestDone[s][total] = 1;
+	}
+	return bestMemo[s][total];
+}
+// expected value of one split hand, which starts with a single card and gets dealt another right away
+double splitHandValue(int v, const double *out) {
+	int total = 0, soft = 0;
+	addCard(&total, &soft, v);
+	return hitValue(total, soft, out);
+}
+// prints one row of a table as a bit per up card, bit 0 = up card worth 2
+void printRow(unsigned int bits, int last, const char *label, int value) {
+	printf("\t0x%03X%s // %s %d\n", bits, last ? "" : ",", label, value);
+}
+// works out the advice tables for the rules the engine was built with
+void tablesBuild() {
+	for (int v = 2; v <= 11; v++) { cardOdds[v] = (v == 10 ? 4.0 : 1.0) / MAXSUIT; }
+	memset(dealerOut, 0, sizeof(dealerOut));
+	for (int up = 2; up <= 11; up++) {
+		dealerFrom(up, up == 11, 1.0, dealerOut[up]);
+	}
+
+	unsigned int *hard = adviceHard, *soft = adviceSoft, *pair = adviceSplit;
+	memset(adviceHard, 0, sizeof(adviceHard));
+	memset(adviceSoft, 0, sizeof(adviceSoft));
+	memset(adviceSplit, 0, sizeof(adviceSplit));
+	for (int up = 2; up <= 11; up++) {
+		const double *out = dealerOut[up];
+		memset(bestDone, 0, sizeof(bestDone));
+		for (int t = 4; t <= 21; t++) {
+			if (t < 21 && hitValue(t, 0, out) > stayValue(t, out)) { hard[t] |= 1 << (up - 2); }
+		}
+		for (int t = 12; t <= 21; t++) {
+			if (t < 21 && hitValue(t, 1, out) > stayValue(t, out)) { soft[t] |= 1 << (up - 2); }
+		}
+		for (int v = 2; v <= 11; v++) {
+			int total = 0, s = 0;
+			addCard(&total, &s, v);
+			addCard(&total, &s, v);
+			if (2 * splitHandValue(v, out) > bestValue(total, s, out)) { pair[v] |= 1 << (up - 2); }
+		}
+	}
+}
+// prints strategy.h for the rules the engine was built with
+void tablesPrint() {
+	unsigned int *hard = adviceHard, *soft = adviceSoft, *pair = adviceSplit;
+	tablesBuild();
+	printf("// basic strategy and dealer odds for the TAPjack advice line and auto play\n");
+	printf("// generated by sim/tapsim -g, run make tables in sim/ after changing the dealer rules\n");
+	printf("// infinite deck, dealer %s soft 17, no doubling or surrender, one split per hand\n\n", HIT_SOFT17 ? "hits" : "stays on");
+	printf("#ifndef STRATEGY_H\n#define STRATEGY_H\n\n");
+	printf("#define STRATEGY_SOFT17 %d // HIT_SOFT17 the tables were made for\n", HIT_SOFT17);
+	printf("#define HARD_MIN 4 // first row of adviceHard\n");
+	printf("#define SOFT_MIN 12 // first row of adviceSoft\n");
+	printf("#define PAIR_MIN 2 // first row of adviceSplit, a pair of Aces is worth 11 each\n");
+	printf("#define ODDS_BUST %d // column of dealerOdds for the dealer busting, 0-4 are final totals 17-21\n\n", OUT_BUST);
+
+	printf("// bit (up card - 2) set = HIT, clear = STAY\n");
+	printf("const uint16_t adviceHard[%d] PROGMEM = {\n", 21 - 4 + 1);
+	for (int t = 4; t <= 21; t++) { printRow(hard[t], t == 21, "hard", t); }
+	printf("};\n");
+	printf("const uint16_t adviceSoft[%d] PROGMEM = {\n", 21 - 12 + 1);
+	for (int t = 12; t <= 21; t++) { printRow(soft[t], t == 21, "soft", t); }
+	printf("};\n");
+	printf("// bit (up card - 2) set = split the pair\n");
+	printf("const uint16_t adviceSplit[%d] PROGMEM = {\n", 11 - 2 + 1);
+	for (int v = 2; v <= 11; v++) { printRow(pair[v], v == 11, "pair of", v); }
+	printf("};\n");
+	printf("// chance out of 255 of each dealer outcome for up card worth 2-11\n");
+	printf("const uint8_t dealerOdds[%d][%d] PROGMEM = {\n", UPCARDS, NUMOUT);
+	for (int up = 2; up <= 11; up++) {
+		printf("\t{");
+		for (int o = 0; o < NUMOUT; o++) {
+			printf(" %3d%s", (int)(dealerOut[up][o] * 255 + 0.5), o == NUMOUT - 1 ? "" : ",");
+		}
+		printf(" }%s // up card %d\n", up == 11 ? "" : ",", up);
+	}
+	printf("};\n\n#endif\n");
+}
@@ -0,0 +1,74 @@
+// basic strategy and dealer odds for the TAPjack advice line and auto play
+// generated by sim/tapsim -g, run make tables in sim/ after changing the dealer rules
+// infinite deck, dealer hits soft 17, no doubling or surrender, one split per hand
+
+#ifndef STRATEGY_H
+#define STRATEGY_H
+
+#define STRATEGY_SOFT17 1 // HIT_SOFT17 the tables were made for
+#define HARD_MIN 4 // first row of adviceHard
+#define SOFT_MIN 12 // first row of adviceSoft
+#define PAIR_MIN 2 // first row of adviceSplit, a pair of Aces is worth 11 each
+#define ODDS_BUST 5 // column of dealerOdds for the dealer busting, 0-4 are final totals 17-21
+
+// bit (up card - 2) set = HIT, clear = STAY
+const uint16_t adviceHard[18] PROGMEM = {
+	0x3FF, // hard 4
+	0x3FF, // hard 5
+	0x3FF, // hard 6
+	0x3FF, // hard 7
+	0x3FF, // hard 8
+	0x3FF, // hard 9
+	0x3FF, // hard 10
+	0x3FF, // hard 11
+	0x3E3, // hard 12
+	0x3E0, // hard 13
+	0x3E0, // hard 14
+	0x3E0, // hard 15
+	0x3E0, // hard 16
+	0x000, // hard 17
+	0x000, // hard 18
+	0x000, // hard 19
+	0x000, // hard 20
+	0x000 // hard 21
+};
+const uint16_t adviceSoft[10] PROGMEM = {
+	0x3FF, // soft 12
+	0x3FF, // soft 13
+	0x3FF, // soft 14
+	0x3FF, // soft 15
+	0x3FF, // soft 16
+	0x3FF, // soft 17
+	0x380, // soft 18
+	0x000, // soft 19
+	0x000, // soft 20
+	0x000 // soft 21
+};
+// bit (up card - 2) set = split the pair
+const uint16_t adviceSplit[10] PROGMEM = {
+	0x03C, // pair of 2
+	0x03C, // pair of 3
+	0x000, // pair of 4
+	0x000, // pair of 5
+	0x01E, // pair of 6
+	0x03F, // pair of 7
+	0x0FF, // pair of 8
+	0x0DF, // pair of 9
+	0x000, // pair of 10
+	0x3FF // pair of 11
+};
+// chance out of 255 of each dealer outcome for up card worth 2-11
+const uint8_t dealerOdds[10][6] PROGMEM = {
+	{  33,  35,  33,  32,  31,  91 }, // up card 2
+	{  32,  34,  32,  31,  30,  96 }, // up card 3
+	{  31,  32,  31,  30,  29, 101 }, // up card 4
+	{  30,  31,  30,  29,  28, 107 }, // up card 5
+	{  29,  29,  29,  28,  27, 112 }, // up card 6
+	{  94,  35,  20,  20,  19,  67 }, // up card 7
+	{  33,  92,  33,  18,  18,  62 }, // up card 8
+	{  31,  31,  89,  31,  16,  58 }, // up card 9
+	{  28,  28,  28,  87,  28,  54 }, // up card 10
+	{  15,  37,  37,  37,  95,  35 } // up card 11
+};
+
+#endif
@@ -0,0 +1,401 @@
+// TAPjack host front end
+// accepts the firmware's event stream offer and draws the tables from the packets, see events.h
+// every input is one table, a serial port, a recorded stream or - for stdin, so one host can show several
+// -r saves what the first table sends, bench/replay.c plays such a recording back through the firmware
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "engine.h"
+#include "events.h"
+
+#define MAXTABLES 8
+#define MAXSEATS 9 // player numbers are one digit
+#define MAXHANDS (1 + MAXSEATS * SEATHANDS)
+#define PACKET_MAX (EV_MAXLEN + 4) // sync, type, length, payload, check
+#define BAUD_SETTLE_MS 20 // time the firmware gets to switch rates before BAUD_CONFIRM is sent
+
+typedef struct tableHand {
+	int value; // 0 while a card is face down
+	int flags; // EVH_*
+	int size;
+	card cards[MAXHAND];
+	int result; // WIN, LOSS, PUSH, -1 = not settled
+	} tableHand;
+
+typedef struct tableView {
+	const char *name;
+	int fd;
+	int writable; // true = the offer can be answered on fd
+	int seats; // from EV_HELLO
+	int state, player, round;
+	int advice; // HIT or STAY, 0 = no question
+	int error; // last ERR_*, 0 = none
+	tableHand hands[MAXHANDS];
+	unsigned char pend[PACKET_MAX]; // bytes of a packet still being received
+	int pendLen;
+	int offerLen; // chars of EV_OFFER matched so far
+	int baudLen; // chars of BAUD_OFFER matched so far, one more once the rate's ESC has come
+	long baudRate; // rate offered, read a digit at a time
+	unsigned long packets, bad;
+	} tableView;
+
+tableView tables[MAXTABLES];
+int numTables = 0;
+int printMode = 0; // true = one line per packet instead of drawing the tables
+FILE *record = NULL; // -r file the first table's bytes are saved to
+
+const char *stateText[NUMSTATES] = {
+	[ST_ROUND] = "dealing",
+	[ST_TURN] = "turn starts",
+	[ST_SPLIT] = "SPLIT? (HIT for YES) (STAY for NO)",
+	[ST_SPLITTING] = "split",
+	[ST_ACTION] = "HIT or STAY?",
+	[ST_HIT] = "hit",
+	[ST_STAY] = "stayed",
+	[ST_BUST] = "BUSTED",
+	[ST_TAPJACK] = "TAPJACK",
+	[ST_DEALER] = "dealer shows",
+	[ST_DEALER_HIT] = "dealer hits",
+	[ST_DEALER_STAY] = "dealer stays",
+	[ST_DEALER_BUST] = "dealer BUSTED",
+	[ST_DEALER_SKIP] = "every hand BUSTED",
+	[ST_RESULTS] = "results",
+	[ST_OVER] = "game over",
+};
+
+int tableOpen(const char *name, speed_t speed); // add a table reading from name
+void tableFeed(tableView *t, unsigned char b); // take one byte from a table's input
+void tableOffer(tableView *t, unsigned char b); // watch bytes outside packets for the offers
+void tableBaud(tableView *t, unsigned char b); // watch bytes outside packets for the faster link offer
+void tableUpgrade(tableView *t, long baud); // follow the firmware to a faster link
+void tableApply(tableView *t, const unsigned char *p, int len); // apply one checked packet
+void tablePrint(tableView *t, const unsigned char *p, int len); // print one packet as a line
+void tableDraw(tableView *t, int number); // draw one table
+const char *cardText(card c); // two chars for a card
+speed_t baudSpeed(long baud); // termios speed for a baud rate, B0 = none
+void usage(const char *prog);
+
+int main(int argc, char **argv) {
+	long baud = 38400;
+	int opt;
+	while ((opt = getopt(argc, argv, "b:pr:h")) != -1) {
+		switch (opt) {
+			case 'b':
+			baud = atol(optarg);
+			break;
+			case 'p':
+			printMode = 1;
+			break;
+			case 'r':
+			record = fopen(optarg, "wb");
+			if (!record) {
+				perror(optarg);
+				return 1;
+			}
+			break;
+			default:
+			usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+	if (optind == argc || argc - optind > MAXTABLES) {
+		usage(argv[0]);
+		return 1;
+	}
+	speed_t speed = baudSpeed(baud);
+	if (speed == B0) {
+		fprintf(stderr, "%s: %ld baud cannot be set on this host\n", argv[0], baud);
+		return 1;
+	}
+	for (int i = optind; i < argc; i++) {
+		if (!tableOpen(argv[i], speed)) { return 1; }
+	}
+
+	struct pollfd fds[MAXTABLES];
+	int open = numTables;
+	while (open > 0) {
+		for (int i = 0; i < numTables; i++) {
+			fds[i].fd = tables[i].fd;
+			fds[i].events = POLLIN;
+		}
+		if (poll(fds, numTables, -1) < 0) {
+			if (errno == EINTR) { continue; }
+			perror("poll");
+			return 1;
+		}
+		for (int i = 0; i < numTables; i++) {
+			if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) { continue; }
+			unsigned char buf[256];
+			ssize_t n = read(tables[i].fd, buf, sizeof(buf));
+			if (n <= 0) { // end of a recording or the port went away
+				close(tables[i].fd);
+				tables[i].fd = -1; // poll() skips negative fds
+				open--;
+				continue;
+			}
+			if (i == 0 && record) { fwrite(buf, 1, n, record); } // saved as received, bad packets and all
+			for (ssize_t k = 0; k < n; k++) { tableFeed(&tables[i], buf[k]); }
+		}
+		if (!printMode) {
+			printf("\x1B[H\x1B[J"); // whole view is redrawn, a few hundred bytes on the host side
+			for (int i = 0; i < numTables; i++) { tableDraw(&tables[i], i + 1); }
+		}
+		fflush(stdout);
+	}
+	if (record) { fclose(record); }
+	return 0;
+}
+// opens a table's input, a serial port is set to raw at the given speed so the offer can be answered
+int tableOpen(const char *name, speed_t speed) {
+	tableView *t = &tables[numTables];
+	memset(t, 0, sizeof(*t));
+	t->name = name;
+	t->fd = strcmp(name, "-") == 0 ? STDIN_FILENO : open(name, O_RDWR | O_NOCTTY);
+	if (t->fd < 0) { t->fd = open(name, O_RDONLY); } // a recording may be read only
+	if (t->fd < 0) {
+		perror(name);
+		return 0;
+	}
+	struct termios tio;
+	if (tcgetattr(t->fd, &tio) == 0) {
+		cfmakeraw(&tio);
+		cfsetispeed(&tio, speed);
+		cfsetospeed(&tio, speed);
+		tio.c_cflag |= CLOCAL | CREAD;
+		tcsetattr(t->fd, TCSANOW, &tio);
+		t->writable = t->fd != STDIN_FILENO;
+	}
+	for (int i = 0; i < MAXHANDS; i++) { t->hands[i].result = -1; }
+	t->seats = NUMSEATS;
+	numTables++;
+	return 1;
+}
+// collects bytes into packets, a packet that fails its check is let go one byte at a time
+// so the next EV_SYNC in it is tried, anything that does not start a packet is watched for the offer
+void tableFeed(tableView *t, unsigned char b) {
+	t->pend[t->pendLen++] = b;
+	while (t->pendLen > 0) {
+		unsigned char *p = t->pend;
+		int drop = 0;
+		if (p[0] != EV_SYNC) {
+			tableOffer(t, p[0]);
+			drop = 1;
+		} else if (t->pendLen >= 3 && p[2] > EV_MAXLEN) {
+			drop = 1;
+		} else if (t->pendLen >= 3 && t->pendLen == p[2] + 4) {
+			unsigned char sum = 0;
+			for (int i = 1; i < t->pendLen; i++) { sum += p[i]; }
+			if (sum == 0) {
+				t->packets++;
+				if (printMode) { tablePrint(t, p + 1, t->pendLen - 1); }
+				tableApply(t, p + 1, t->pendLen - 1);
+				drop = t->pendLen;
+			} else {
+				t->bad++;
+				drop = 1;
+			}
+		}
+		if (!drop) { return; } // packet is not complete yet
+		t->pendLen -= drop;
+		memmove(p, p + drop, t->pendLen);
+	}
+}
+// answers the firmware's offers once their whole APC string has gone by
+void tableOffer(tableView *t, unsigned char b) {
+	static const char offer[] = EV_OFFER;
+	tableBaud(t, b);
+	if (b == (unsigned char) offer[t->offerLen]) { t->offerLen++; }
+	else { t->offerLen = b == (unsigned char) offer[0]; }
+	if (t->offerLen < (int) sizeof(offer) - 1) { return; }
+	t->offerLen = 0;
+	if (t->writable) {
+		char accept = EV_ACCEPT;
+		if (write(t->fd, &accept, 1) != 1) { perror(t->name); }
+	}
+}
+// reads BAUD_OFFER, the rate in decimal and ESC \, then follows the firmware to that rate
+void tableBaud(tableView *t, unsigned char b) {
+	static const char offer[] = BAUD_OFFER;
+	int len = sizeof(offer) - 1;
+	if (t->baudLen < len) {
+		if (b == (unsigned char) offer[t->baudLen]) { t->baudLen++; }
+		else { t->baudLen = b == (unsigned char) offer[0]; }
+		t->baudRate = 0;
+	} else if (t->baudLen == len && b >= '0' && b <= '9' && t->baudRate < 100000000) {
+		t->baudRate = t->baudRate * 10 + b - '0';
+	} else if (t->baudLen == len && b == 0x1B) {
+		t->baudLen++;
+	} else {
+		if (t->baudLen > len && b == '\\') { tableUpgrade(t, t->baudRate); }
+		t->baudLen = b == (unsigned char) offer[0];
+	}
+}
+// answers BAUD_ACCEPT, moves the port to the new rate and confirms at it
+// a rate this host cannot set is not answered, so the firmware stays at its reset rate
+void tableUpgrade(tableView *t, long baud) {
+	speed_t speed = baudSpeed(baud);
+	struct termios tio;
+	if (!t->writable || speed == B0 || tcgetattr(t->fd, &tio) != 0) {
+		fprintf(stderr, "%s: staying at the reset rate, cannot follow to %ld baud\n", t->name, baud);
+		return;
+	}
+	char c = BAUD_ACCEPT;
+	if (write(t->fd, &c, 1) != 1) {
+		perror(t->name);
+		return;
+	}
+	tcdrain(t->fd); // the answer goes out at the old rate
+	cfsetispeed(&tio, speed);
+	cfsetospeed(&tio, speed);
+	tcsetattr(t->fd, TCSANOW, &tio);
+	usleep(BAUD_SETTLE_MS * 1000);
+	c = BAUD_CONFIRM;
+	if (write(t->fd, &c, 1) != 1) { perror(t->name); }
+	if (printMode) { printf("%d link at %ld baud\n", (int) (t - tables) + 1, baud); }
+}
+// updates a table from one packet, p starts at its type
+void tableApply(tableView *t, const unsigned char *p, int len) {
+	const unsigned char *d = p + 2;
+	int n = p[1];
+	tableHand *h;
+	switch (p[0]) {
+		case EV_HELLO:
+		if (n >= 3 && d[0] == EV_VERSION && d[1] <= MAXSEATS && d[2] == SEATHANDS) { t->seats = d[1]; }
+		else { fprintf(stderr, "%s: stream is for another version of tapview\n", t->name); }
+		break;
+		case EV_STATE:
+		if (n < 4 || d[0] >= NUMSTATES) { break; }
+		t->state = d[0];
+		t->player = d[1];
+		t->round = d[2] | (d[3] << 8);
+		t->advice = 0;
+		if (t->state == ST_ROUND) {
+			t->error = 0;
+			for (int i = 0; i < MAXHANDS; i++) { t->hands[i].result = -1; }
+		}
+		break;
+		case EV_HAND:
+		if (n < 3 || d[0] >= MAXHANDS || n - 3 > MAXHAND) { break; }
+		h = &t->hands[d[0]];
+		h->value = d[1];
+		h->flags = d[2];
+		h->size = n - 3;
+		memcpy(h->cards, d + 3, h->size);
+		break;
+		case EV_RESULT:
+		if (n >= 2 && d[0] < MAXHANDS) { t->hands[d[0]].result = d[1]; }
+		break;
+		case EV_ADVICE:
+		if (n >= 1) { t->advice = d[0]; }
+		break;
+		case EV_ERROR:
+		if (n >= 1) { t->error = d[0]; }
+		break;
+	}
+}
+// prints one packet as a line of text, p starts at its type
+void tablePrint(tableView *t, const unsigned char *p, int len) {
+	const unsigned char *d = p + 2;
+	int n = p[1];
+	printf("%d ", (int) (t - tables) + 1);
+	switch (p[0]) {
+		case EV_HELLO:
+		printf("hello version %d seats %d hands %d\n", d[0], d[1], d[2]);
+		break;
+		case EV_STATE:
+		printf("state %s player %d round %d\n", d[0] < NUMSTATES ? stateText[d[0]] : "?", d[1], d[2] | (d[3] << 8));
+		break;
+		case EV_HAND:
+		printf("hand %d value %d%s%s%s", d[0], d[1], d[2] & EVH_SOFT ? " soft" : "",
+			d[2] & EVH_BUSTED ? " busted" : "", d[2] & EVH_HIDDEN ? " hidden" : "");
+		for (int i = 3; i < n; i++) { printf(" %s", cardText(d[i])); }
+		printf("\n");
+		break;
+		case EV_RESULT:
+		printf("result %d %s\n", d[0], d[1] == WIN ? "won" : d[1] == PUSH ? "pushed" : "lost");
+		break;
+		case EV_ADVICE:
+		printf("advice %s\n", d[0] == HIT ? "HIT" : "STAY");
+		break;
+		case EV_ERROR:
+		printf("error %d\n", d[0]);
+		break;
+		case EV_SEED:
+		printf("seed %lu\n", d[0] | ((unsigned long) d[1] << 8) | ((unsigned long) d[2] << 16) | ((unsigned long) d[3] << 24));
+		break;
+		case EV_INPUT:
+		printf("input %s to %s after %d ms\n", d[1] == HIT ? "HIT" : "STAY", d[0] < NUMSTATES ? stateText[d[0]] : "?", d[2] | (d[3] << 8));
+		break;
+		default:
+		printf("packet %d, %d bytes\n", p[0], n);
+		break;
+	}
+}
+// draws one table: where the round is, then the dealer and every seat a row each
+void tableDraw(tableView *t, int number) {
+	printf("table %d, %s: round %d, ", number, t->name, t->round);
+	if (t->player == DEALER || t->state == ST_ROUND || t->state >= ST_RESULTS) { printf("%s", stateText[t->state]); }
+	else { printf("player %d, %s", t->player, stateText[t->state]); }
+	if (t->advice) { printf(", advice %s", t->advice == HIT ? "HIT" : "STAY"); }
+	if (t->error == ERR_DEAL) { printf(", cannot deal card"); }
+	if (t->bad) { printf(", %lu bad packets", t->bad); }
+	printf("\n");
+	for (int id = 0; id < 1 + t->seats * SEATHANDS; id++) {
+		tableHand *h = &t->hands[id];
+		int seat = id ? (id - 1) / SEATHANDS + P1 : DEALER;
+		if (id > 0 && (id - 1) % SEATHANDS > 0 && h->size == 0) { continue; } // no split hand
+		if (id == 0) { printf("  dealer   "); }
+		else if ((id - 1) % SEATHANDS == 0) { printf("  player %d ", seat); }
+		else { printf("           "); }
+		int col = 0;
+		for (int i = 0; i < h->size; i++) { col += printf(" [%s]", cardText(h->cards[i])); }
+		printf("%*s", col < 40 ? 40 - col : 0, "");
+		if (h->size > 0 && !(h->flags & EVH_HIDDEN)) { printf(" %2d%s", h->value, h->flags & EVH_BUSTED ? " bust" : h->flags & EVH_SOFT ? " soft" : ""); }
+		if (h->result >= 0) { printf("  %s", h->result == WIN ? "WON" : h->result == PUSH ? "PUSHED" : "LOST"); }
+		if (id > 0 && seat == t->player && t->state > ST_ROUND && t->state < ST_DEALER) { printf("  <"); } // whose turn it is
+		printf("\n");
+	}
+	printf("\n");
+}
+// a card as rank and suit letter, ?? while it is face down
+const char *cardText(card c) {
+	static char text[3];
+	if (c & CARD_DOWN) { return "??"; }
+	text[0] = "A23456789TJQK"[cardRank(c) - 1];
+	text[1] = cardSuit(c) < 4 ? "HDCS"[cardSuit(c)] : '?';
+	text[2] = '\0';
+	return text;
+}
+// termios speed for the rates the firmware can run at, B0 if this host's termios has none for the rate
+speed_t baudSpeed(long baud) {
+	switch (baud) {
+		case 9600: return B9600;
+		case 19200: return B19200;
+		case 38400: return B38400;
+		case 57600: return B57600;
+		case 115200: return B115200;
+		case 230400: return B230400;
+#ifdef B76800
+		case 76800: return B76800;
+#endif
+#ifdef B250000
+		case 250000: return B250000;
+#endif
+#ifdef B500000
+		case 500000: return B500000;
+		case 1000000: return B1000000;
+#endif
+		default: return B0; // B0 hangs up, so it is never a rate asked for
+	}
+}
+void usage(const char *prog) {
+	fprintf(stderr, "usage: %s [-b baud] [-p] [-r file] port-or-file...\n"
+		"  every input is a table, - reads stdin, -p prints packets as lines instead of drawing,\n"
+		"  -r saves what the first table sends for bench/tapreplay\n", prog);
+}